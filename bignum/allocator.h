@@ -0,0 +1,425 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include "mathprimatives.h"
+
+// words in the first block of a thread's scratch arena
+#ifndef BIGNUM_SCRATCH_ARENA_WORDS
+#define BIGNUM_SCRATCH_ARENA_WORDS 16384
+#endif
+
+// free blocks each limb pool size class keeps for reuse
+#ifndef BIGNUM_POOL_CACHED_BLOCKS
+#define BIGNUM_POOL_CACHED_BLOCKS 16
+#endif
+
+namespace bignum
+{
+	// ==============================================================
+	//      allocation
+	// ==============================================================
+	//
+	// Storage for the run time sized integer comes from an allocator policy:
+	//
+	//   static u32* allocate (size_t words, size_t& capacity)
+	//       a block of at least words words, capacity set to its real size
+	//   static void deallocate (u32* block, size_t capacity)
+	//   class buffer
+	//       scratch words for the span of one operation, buffer(words).data()
+	//
+	// heap_allocator uses new / delete throughout. pooled_allocator takes
+	// results from per thread size class pools and scratch from a per thread
+	// bump arena, so a hot loop stops allocating once the pools are warm.
+	// All of it is per thread; a block may be freed on another thread than the
+	// one that allocated it, it then joins that thread's pool.
+
+	// per thread, see allocationCounters()
+	struct allocation_counters
+	{
+		size_t allocations;				// blocks taken from the heap
+		size_t bytesAllocated;
+		size_t allocationsAvoided;		// requests met from a pool or the arena
+		size_t bytesAvoided;
+	};
+
+	inline allocation_counters& allocationCounters ()
+	{
+		thread_local allocation_counters counters = {};
+		return counters;
+	}
+
+	inline mathprim::u32* heapAllocate (size_t words)
+	{
+		allocation_counters& counters = allocationCounters();
+		counters.allocations++;
+		counters.bytesAllocated += words * sizeof(mathprim::u32);
+
+		return new mathprim::u32[words];
+	}
+
+	inline void countAvoided (size_t words)
+	{
+		allocation_counters& counters = allocationCounters();
+		counters.allocationsAvoided++;
+		counters.bytesAvoided += words * sizeof(mathprim::u32);
+	}
+
+	// ==============================================================
+	//      scratch arena
+	// ==============================================================
+	//
+	// A stack of blocks that allocations bump through. Space is given back
+	// only by rewinding to a mark, which scratch_scope does on exit. When the
+	// outermost scope closes, a value that spilled into further blocks is
+	// merged into a single block of the high water size, so the next batch
+	// fits without allocating.
+
+	class scratch_arena
+	{
+		public:
+			struct mark_t
+			{
+				size_t block;
+				size_t used;
+			};
+
+			static scratch_arena& local ()
+			{
+				thread_local scratch_arena arena;
+				return arena;
+			}
+
+			~scratch_arena ()
+			{
+				for (block_t& b : m_blocks)
+					delete[] b.words;
+			}
+
+			// words rounded up to 16 bytes, so every allocation is aligned for u64 limbs
+			mathprim::u32* allocate (size_t words)
+			{
+				words = (words + 3) & ~size_t(3);
+
+				if (m_blocks.empty() || m_used + words > m_blocks[m_block].size)
+					nextBlock (words);
+				else
+					countAvoided (words);
+
+				mathprim::u32* result = m_blocks[m_block].words + m_used;
+				m_used += words;
+				return result;
+			}
+
+			mark_t mark () const
+			{
+				return mark_t { m_block, m_used };
+			}
+
+			void rewind (const mark_t& mark)
+			{
+				m_block = mark.block;
+				m_used = mark.used;
+			}
+
+			void enter ()
+			{
+				m_depth++;
+			}
+
+			void leave ()
+			{
+				if (--m_depth == 0 && m_blocks.size() > 1)
+				{
+					size_t total = 0;
+					for (block_t& b : m_blocks)
+					{
+						total += b.size;
+						delete[] b.words;
+					}
+
+					m_blocks.clear();
+					m_blocks.push_back(block_t { heapAllocate(total), total });
+					m_block = 0;
+					m_used = 0;
+				}
+			}
+
+			// words currently held, whether in use or not
+			size_t capacity () const
+			{
+				size_t total = 0;
+				for (const block_t& b : m_blocks)
+					total += b.size;
+				return total;
+			}
+
+		private:
+			struct block_t
+			{
+				mathprim::u32* words;
+				size_t size;
+			};
+
+			std::vector<block_t> m_blocks;
+			size_t m_block = 0;
+			size_t m_used = 0;
+			size_t m_depth = 0;
+
+			scratch_arena () = default;
+			scratch_arena (const scratch_arena&) = delete;
+			scratch_arena& operator= (const scratch_arena&) = delete;
+
+			// moves to a following block that holds words, or replaces the ones
+			// after the current block with a new one twice its size
+			void nextBlock (size_t words)
+			{
+				if (m_blocks.empty())
+				{
+					size_t size = std::max(words, size_t(BIGNUM_SCRATCH_ARENA_WORDS));
+					m_blocks.push_back(block_t { heapAllocate(size), size });
+					m_block = 0;
+					m_used = 0;
+					return;
+				}
+
+				if (m_block + 1 < m_blocks.size() && m_blocks[m_block + 1].size >= words)
+				{
+					countAvoided (words);
+				}
+				else
+				{
+					for (size_t i = m_block + 1; i < m_blocks.size(); i++)
+						delete[] m_blocks[i].words;
+					m_blocks.resize(m_block + 1);
+
+					size_t size = std::max(words, 2 * m_blocks[m_block].size);
+					m_blocks.push_back(block_t { heapAllocate(size), size });
+				}
+
+				m_block++;
+				m_used = 0;
+			}
+	};
+
+	// Scratch from the calling thread's arena for the life of the scope. Scopes
+	// nest; an outer one around a batch of operations keeps the arena from
+	// merging its blocks until the batch is done, and its own allocations live
+	// until it closes
+	class scratch_scope
+	{
+		public:
+			scratch_scope () : m_arena(scratch_arena::local()), m_mark(m_arena.mark())
+			{
+				m_arena.enter();
+			}
+
+			~scratch_scope ()
+			{
+				m_arena.rewind(m_mark);
+				m_arena.leave();
+			}
+
+			mathprim::u32* allocate (size_t words)
+			{
+				return m_arena.allocate(words);
+			}
+
+		private:
+			scratch_arena& m_arena;
+			scratch_arena::mark_t m_mark;
+
+			scratch_scope (const scratch_scope&) = delete;
+			scratch_scope& operator= (const scratch_scope&) = delete;
+	};
+
+	// ==============================================================
+	//      limb pool
+	// ==============================================================
+	//
+	// Free lists of blocks in power of two size classes from min_words up to
+	// max_words words, linked through the blocks themselves. Larger blocks go
+	// straight to the heap.
+
+	class limb_pool
+	{
+		public:
+			static const size_t min_words = 16;
+			static const size_t max_words = 1 << 16;
+			static const size_t classes = 13;		// log2(max_words / min_words) + 1
+
+			static limb_pool& local ()
+			{
+				thread_local limb_pool pool;
+				return pool;
+			}
+
+			// set once the thread's pool is gone, for values destroyed after it
+			static bool& destroyed ()
+			{
+				thread_local bool flag = false;
+				return flag;
+			}
+
+			~limb_pool ()
+			{
+				for (size_t c = 0; c < classes; c++)
+				{
+					while (m_free[c])
+					{
+						node_t* next = m_free[c]->next;
+						delete[] reinterpret_cast<mathprim::u32*>(m_free[c]);
+						m_free[c] = next;
+					}
+				}
+
+				destroyed() = true;
+			}
+
+			mathprim::u32* allocate (size_t words, size_t& capacity)
+			{
+				if (words > max_words)
+				{
+					capacity = words;
+					return heapAllocate(words);
+				}
+
+				size_t c = sizeClass (words);
+				capacity = min_words << c;
+
+				if (m_free[c])
+				{
+					node_t* block = m_free[c];
+					m_free[c] = block->next;
+					m_count[c]--;
+					countAvoided (capacity);
+					return reinterpret_cast<mathprim::u32*>(block);
+				}
+
+				return heapAllocate(capacity);
+			}
+
+			void deallocate (mathprim::u32* block, size_t capacity)
+			{
+				if (capacity > max_words || capacity < min_words)
+				{
+					delete[] block;
+					return;
+				}
+
+				size_t c = sizeClass (capacity);
+				if (m_count[c] >= BIGNUM_POOL_CACHED_BLOCKS)
+				{
+					delete[] block;
+					return;
+				}
+
+				node_t* node = reinterpret_cast<node_t*>(block);
+				node->next = m_free[c];
+				m_free[c] = node;
+				m_count[c]++;
+			}
+
+		private:
+			struct node_t
+			{
+				node_t* next;
+			};
+
+			node_t* m_free[classes] = {};
+			size_t m_count[classes] = {};
+
+			limb_pool () = default;
+			limb_pool (const limb_pool&) = delete;
+			limb_pool& operator= (const limb_pool&) = delete;
+
+			// smallest class holding words words
+			static size_t sizeClass (size_t words)
+			{
+				size_t c = 0;
+				while ((min_words << c) < words)
+					c++;
+				return c;
+			}
+	};
+
+	// ==============================================================
+	//      allocator policies
+	// ==============================================================
+
+	struct heap_allocator
+	{
+		static mathprim::u32* allocate (size_t words, size_t& capacity)
+		{
+			capacity = words;
+			return heapAllocate(words);
+		}
+
+		static void deallocate (mathprim::u32* block, size_t)
+		{
+			delete[] block;
+		}
+
+		class buffer
+		{
+			public:
+				explicit buffer (size_t words) : m_words(heapAllocate(words))
+				{
+				}
+
+				~buffer ()
+				{
+					delete[] m_words;
+				}
+
+				mathprim::u32* data ()
+				{
+					return m_words;
+				}
+
+			private:
+				mathprim::u32* m_words;
+
+				buffer (const buffer&) = delete;
+				buffer& operator= (const buffer&) = delete;
+		};
+	};
+
+	struct pooled_allocator
+	{
+		static mathprim::u32* allocate (size_t words, size_t& capacity)
+		{
+			if (limb_pool::destroyed())
+				return heap_allocator::allocate(words, capacity);
+
+			return limb_pool::local().allocate(words, capacity);
+		}
+
+		static void deallocate (mathprim::u32* block, size_t capacity)
+		{
+			if (limb_pool::destroyed())
+				delete[] block;
+			else
+				limb_pool::local().deallocate(block, capacity);
+		}
+
+		class buffer
+		{
+			public:
+				explicit buffer (size_t words) : m_words(m_scope.allocate(words))
+				{
+				}
+
+				mathprim::u32* data ()
+				{
+					return m_words;
+				}
+
+			private:
+				scratch_scope m_scope;
+				mathprim::u32* m_words;
+		};
+	};
+}
@@ -5,6 +5,8 @@
 
 namespace bignum
 {
+	template <typename bigfixed_t> class fixed_functions;
+
 	template <size_t numwords, size_t numwords_frac>
 	class bigfixed
 	{
@@ -21,9 +23,11 @@ namespace bignum
 			const static size_t size_bits_frac  = size_words_frac * 32;
 			const static size_t size_bits       = size_words * 32;
 
+			class reciprocal_t;
 
 		private:
 			template <size_t numwords2, size_t numwords_frac2> friend class bigfixed;
+			template <typename bigfixed_t> friend class fixed_functions;
 			
 			internal_t m_internalValue;
 
@@ -85,12 +89,12 @@ namespace bignum
 
 			inline this_t operator+(const this_t& value) const
 			{
-				return *this + value;
+				return this_t(m_internalValue + value.m_internalValue);
 			}
 
 			inline this_t operator-(const this_t& value) const
 			{
-				return *this - value;
+				return this_t(m_internalValue - value.m_internalValue);
 			}
 
 			inline this_t operator-() const
@@ -100,36 +104,41 @@ namespace bignum
 
 			inline this_t& operator+=(const this_t& value)
 			{
-				return *this += value;
+				m_internalValue += value.m_internalValue;
+				return *this;
 			}
 
 			inline this_t& operator-=(const this_t& value)
 			{
-				return *this -= value;
+				m_internalValue -= value.m_internalValue;
+				return *this;
 			}
 
+			// the double width product, less the extra fraction bits
 			inline this_t operator*(const this_t& value) const
 			{
-				intermediate_t a = m_internalValue.cast<intermediate_t>();
-				intermediate_t b = value.m_internalValue.cast<intermediate_t>();
+				typename internal_t::wide_t res = internal_t::mulFull(m_internalValue, value.m_internalValue);
+				res >>= size_bits_frac;
 
-				intermediate_t res = a * b;
-				res =>> size_bits_frac;
-
-				return this_t(res.cast<internal_t>());
+				return this_t(res.template cast<internal_t>());
 			}
 
+			// a / value truncated toward zero. The dividend gains size_bits_frac bits,
+			// intermediate_t holds it exactly
 			inline this_t operator/(const this_t& value) const
 			{
-				intermediate_t a = m_internalValue.cast<intermediate_t>();
-				intermediate_t b = value.m_internalValue.cast<intermediate_t>();
+				intermediate_t a = m_internalValue.template cast<intermediate_t>();
+				intermediate_t b = value.m_internalValue.template cast<intermediate_t>();
 
-				a =<< size_bits_frac;
-				b =<< size_bits_frac;	
-				
-				intermediate_t res = a / b;
+				a <<= size_bits_frac;
+
+				return this_t((a / b).template cast<internal_t>());
+			}
 
-				return this_t(res.cast<internal_t>());
+			// multiplies by 1/value, a * d.reciprocal() == a / d
+			inline this_t operator*(const reciprocal_t& value) const
+			{
+				return value.div(*this);
 			}
 
 			inline this_t& operator*=(const this_t& value)
@@ -144,6 +153,44 @@ namespace bignum
 				return *this;
 			}
 
+			// ==============================================================
+			//      Reciprocal
+			// ==============================================================
+
+			// The reciprocal of a fixed denominator, so that dividing by it is a multiply:
+			// the Newton-Raphson reciprocal of intermediate_t::divider, which the shifted
+			// dividends go through. Quotients are exact, as operator/
+			class reciprocal_t
+			{
+				public:
+					reciprocal_t (const this_t& value) : m_divider(value.m_internalValue.template cast<intermediate_t>())
+					{
+					}
+
+					// a / d truncated toward zero
+					this_t div (const this_t& a) const
+					{
+						intermediate_t dividend = a.m_internalValue.template cast<intermediate_t>();
+						dividend <<= size_bits_frac;
+
+						return this_t(m_divider.div(dividend).template cast<internal_t>());
+					}
+
+					// 1/d truncated toward zero
+					this_t value () const
+					{
+						return div (this_t(1));
+					}
+
+				private:
+					typename intermediate_t::divider m_divider;
+			};
+
+			reciprocal_t reciprocal () const
+			{
+				return reciprocal_t(*this);
+			}
+
 			// ==============================================================
 			//      conversion functions
 			// ==============================================================
@@ -177,35 +224,120 @@ namespace bignum
 
 			std::string toDecString () const
 			{
-				std::string out;
+				char buffer[maxChars()];
+				return std::string(buffer, toChars(buffer, buffer + sizeof(buffer)).ptr);
+			}
+
+			static this_t fromDecString (const std::string& s)
+			{
+				this_t value;
+				const char* end = s.c_str() + s.size();
+
+				std::from_chars_result result = fromChars(s.c_str(), end, value);
+				if (result.ec != std::errc() || result.ptr != end)
+					throw std::invalid_argument("Invalid Decimal String");
+
+				return value;
+			}
 
-				if (m_internalValue == 0) return "0.0";
+			// largest number of characters toChars can write: sign, whole digits, point and
+			// one fractional digit per fractional bit (2^-n has n decimal places)
+			static constexpr size_t maxChars ()
+			{
+				return internal_t::template maxCharsFor<10>() + 1 + size_bits_frac;
+			}
 
+			// writes [-]whole.fraction to [first, last) in the manner of std::to_chars. The
+			// fraction is exact, with at least one digit
+			std::to_chars_result toChars (char* first, char* last) const
+			{
 				bool neg = m_internalValue.isNegative();
 
 				internal_t absValue = neg?-m_internalValue:m_internalValue;
 				internal_t wholePart = absValue >> size_bits_frac;  // shift out the fractional part
 				internal_t fractionalPart = absValue - (wholePart << size_bits_frac);
 
-				out = wholePart.toDecString() + ".";
+				char* p = first;
+				if (neg)
+				{
+					if (p == last)
+						return { last, std::errc::value_too_large };
+					*p++ = '-';
+				}
+
+				std::to_chars_result result = wholePart.toChars(p, last);
+				if (result.ec != std::errc())
+					return result;
+
+				p = result.ptr;
+				if (p == last)
+					return { last, std::errc::value_too_large };
+				*p++ = '.';
 
-				std::string fracstr;
-				while (fractionalPart != 0)
+				do
 				{
+					if (p == last)
+						return { last, std::errc::value_too_large };
+
 					internal_t::mulBy10(fractionalPart, fractionalPart);
-					fracstr += '0' + fractionalPart.getWord(size_words_frac);
+					*p++ = char('0' + fractionalPart.getWord(size_words_frac));
 					fractionalPart.setWord(size_words_frac, 0);
 				}
+				while (fractionalPart != 0);
 
-				if (fracstr.size() == 0)
-					fracstr += '0';
-
-				return std::string (neg?"-":"") + out + fracstr;
+				return { p, std::errc() };
 			}
 
-			static this_t fromDecString (const std::string& s)
+			// parses [-]digits[.digits] from [first, last) in the manner of std::from_chars.
+			// The fraction is rounded down to the nearest representable value
+			static std::from_chars_result fromChars (const char* first, const char* last, this_t& value)
 			{
-				return this_t;
+				const char* p = first;
+				bool neg = p != last && *p == '-';
+				if (neg)
+					p++;
+
+				const char* whole = p;
+				while (p != last && *p >= '0' && *p <= '9')
+					p++;
+				const char* wholeEnd = p;
+
+				const char* frac = p;
+				if (p != last && *p == '.')
+				{
+					frac = ++p;
+					while (p != last && *p >= '0' && *p <= '9')
+						p++;
+				}
+				const char* fracEnd = p;
+
+				if (whole == wholeEnd && frac == fracEnd)
+					return { first, std::errc::invalid_argument };
+
+				internal_t wholePart;
+				if (whole != wholeEnd)
+				{
+					std::from_chars_result result = internal_t::fromChars(whole, wholeEnd, wholePart);
+					if (result.ec != std::errc() || (wholePart >> (size_bits_whole - 1)) != 0)
+						return { p, std::errc::result_out_of_range };
+				}
+
+				// from the last digit back: f = (digit + f) / 10, truncating each step,
+				// which gives the truncated value of the whole fraction
+				internal_t fractionalPart;
+				if (size_bits_frac > 0)
+				{
+					for (const char* d = fracEnd; d != frac;)
+					{
+						--d;
+						fractionalPart.setWord(size_words_frac, mathprim::u32(*d - '0'));
+						internal_t::template divc<10>::div(fractionalPart, fractionalPart);
+					}
+				}
+
+				internal_t result = (wholePart << size_bits_frac) + fractionalPart;
+				value = this_t(neg?-result:result);
+				return { p, std::errc() };
 			}
 
 			// ==============================================================
@@ -263,4 +395,16 @@ namespace bignum
 
 	};
 
+	// std::to_chars / std::from_chars style conversions, see bigfixed::toChars / fromChars
+	template <size_t numwords, size_t numwords_frac>
+	std::to_chars_result to_chars (char* first, char* last, const bigfixed<numwords, numwords_frac>& value)
+	{
+		return value.toChars(first, last);
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	std::from_chars_result from_chars (const char* first, const char* last, bigfixed<numwords, numwords_frac>& value)
+	{
+		return bigfixed<numwords, numwords_frac>::fromChars(first, last, value);
+	}
 }
@@ -0,0 +1,476 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "bigfixed.h"
+#include "bigintmath.h"
+
+namespace bignum
+{
+	// ==============================================================
+	//      Elementary functions
+	// ==============================================================
+	//
+	// sqrt and rsqrt are exact, the truncated root from isqrt. The others
+	// reduce their argument against a small table and finish with a short
+	// polynomial, with two or three guard words below the fraction, then
+	// round to nearest, so are good to an ulp or so. The constants, tables
+	// and polynomials are computed once per bigfixed type, on first use.
+	//
+	// exp's error is relative, near 2^-(frac_bits - 8), so is several ulps
+	// once its result passes 2^(guard_bits - 8). sin and cos reduce by pi/2
+	// held to the working precision, so lose accuracy as |x| nears 2^guard_bits.
+
+	template <typename bigfixed_t>
+	class fixed_functions
+	{
+		public:
+			// at least 64 guard bits, and an even word count for the 64 bit limbs
+			static const size_t guard_words = 2 + bigfixed_t::size_words % 2;
+			static const size_t guard_bits  = guard_words * 32;
+
+			typedef bigfixed<bigfixed_t::size_words_whole, bigfixed_t::size_words_frac + guard_words> work_t;
+			typedef typename work_t::internal_t int_t;
+
+			// reduced arguments and the polynomials, with one or two whole words
+			typedef bigint<(bigfixed_t::size_words_frac + guard_words + 2) & ~size_t(1), true> series_t;
+
+			static const size_t frac_bits = work_t::size_bits_frac;
+
+		private:
+			typedef typename bigfixed_t::internal_t internal_t;
+
+			struct constants_t
+			{
+				int_t pi;
+				int_t halfPi;
+				int_t quarterPi;
+				int_t ln2;
+
+				series_t logTable[17];     // log(j / 32),  j = 16..32
+				series_t sinTable[14];     // sin(j / 16),  j = 0..13
+				series_t cosTable[14];     // cos(j / 16)
+				series_t atanTable[17];    // atan(j / 16), j = 0..16
+
+				// truncated series, with the terms their reduced arguments need
+				std::vector<series_t> expCoefs;      // 1 / k!
+				std::vector<series_t> sinCoefs;      // (-1)^i / (2i+1)!
+				std::vector<series_t> cosCoefs;      // (-1)^i / (2i)!
+				std::vector<series_t> atanCoefs;     // (-1)^i / (2i+1)
+				std::vector<series_t> atanhCoefs;    // 1 / (2i+1)
+			};
+
+	// ==============================================================
+	//      Fixed point helpers, frac_bits fraction bits
+	// ==============================================================
+
+			template <typename T>
+			static T one ()
+			{
+				return T(1) << frac_bits;
+			}
+
+			template <typename T>
+			static T mul (const T& a, const T& b)
+			{
+				typename T::wide_t product = T::mulFull (a, b);
+				product >>= frac_bits;
+				return product.template cast<T>();
+			}
+
+			template <typename T>
+			static T div (const T& a, const T& b)
+			{
+				typedef typename T::wide_t wide_t;
+				wide_t dividend = a.template cast<wide_t>() << frac_bits;
+				return (dividend / b.template cast<wide_t>()).template cast<T>();
+			}
+
+			// j / 2^bits
+			static series_t ratio (size_t j, size_t bits)
+			{
+				return series_t(int(j)) << (frac_bits - bits);
+			}
+
+			// nearest j / 2^bits to non negative x
+			static size_t nearest (const series_t& x, size_t bits)
+			{
+				return ((x >> (frac_bits - bits - 1)).getWord(0) + 1) >> 1;
+			}
+
+			static int_t toWork (const bigfixed_t& x)
+			{
+				return x.m_internalValue.template cast<int_t>() << guard_bits;
+			}
+
+			// rounded to nearest
+			static bigfixed_t fromWork (const int_t& x)
+			{
+				return bigfixed_t(((x + (int_t(1) << (guard_bits - 1))) >> guard_bits).template cast<internal_t>());
+			}
+
+			static bigfixed_t fromWork (const series_t& x)
+			{
+				return fromWork (x.template cast<int_t>());
+			}
+
+	// ==============================================================
+	//      Series
+	// ==============================================================
+
+			// sum of coefs[i] x^i
+			static series_t horner (const std::vector<series_t>& coefs, const series_t& x)
+			{
+				series_t sum = coefs.back();
+				for (size_t i = coefs.size() - 1; i-- > 0;)
+					sum = mul (sum, x) + coefs[i];
+
+				return sum;
+			}
+
+			// 1 / k!, while bound^k / k! is non zero
+			static std::vector<series_t> factorialCoefs (const series_t& bound)
+			{
+				std::vector<series_t> coefs (1, one<series_t>());
+				series_t inverse = one<series_t>();
+				series_t power = one<series_t>();
+
+				for (int k = 1; ; k++)
+				{
+					inverse = inverse / series_t(k);
+					power = mul (power, bound);
+					if (mul (power, inverse) == 0)
+						return coefs;
+
+					coefs.push_back (inverse);
+				}
+			}
+
+			// (-1)^i / (2i+1), or all positive, while bound^(2i+1) / (2i+1) is non zero
+			static std::vector<series_t> oddCoefs (const series_t& bound, bool alternating)
+			{
+				std::vector<series_t> coefs (1, one<series_t>());
+				series_t bound2 = mul (bound, bound);
+				series_t power = bound;
+
+				for (int i = 1; ; i++)
+				{
+					series_t inverse = one<series_t>() / series_t(2 * i + 1);
+					power = mul (power, bound2);
+					if (mul (power, inverse) == 0)
+						return coefs;
+
+					coefs.push_back ((alternating && (i & 1)) ? -inverse : inverse);
+				}
+			}
+
+			// exact arguments, for the tables
+			// t - t^3/3 + t^5/5 ..., or all added for atanh
+			static series_t atanSeries (const series_t& t, bool hyperbolic)
+			{
+				series_t t2 = mul (t, t);
+				series_t power = t;
+				series_t sum = t;
+
+				for (int n = 1; ; n++)
+				{
+					power = mul (power, t2);
+					series_t term = power / series_t(2 * n + 1);
+					if (term == 0)
+						break;
+
+					if (hyperbolic || !(n & 1))
+						sum += term;
+					else
+						sum -= term;
+				}
+
+				return sum;
+			}
+
+			static void sinCosSeries (const series_t& t, series_t& sint, series_t& cost)
+			{
+				series_t term = t;
+				sint = t;
+				cost = one<series_t>();
+
+				for (int n = 2; ; n++)
+				{
+					term = mul (term, t) / series_t(n);
+					if (term == 0)
+						break;
+
+					switch (n & 3)
+					{
+						case 0: cost += term; break;
+						case 1: sint += term; break;
+						case 2: cost -= term; break;
+						case 3: sint -= term; break;
+					}
+				}
+			}
+
+			// exp(r) = exp(r / 2^s)^(2^s); s near sqrt(frac_bits) / 2 costs about
+			// as many multiplies as larger s, and each squaring doubles the error
+			static size_t expSquarings ()
+			{
+				size_t s = 1;
+				while (4 * s * s < frac_bits)
+					s++;
+
+				return s;
+			}
+
+	// ==============================================================
+	//      Constants
+	// ==============================================================
+
+			static constants_t makeConstants ()
+			{
+				constants_t c;
+				series_t one = fixed_functions::one<series_t>();
+
+				// Machin: pi/4 = 4 atan(1/5) - atan(1/239)
+				series_t pi = (atanSeries (one / series_t(5), false) << 4) - (atanSeries (one / series_t(239), false) << 2);
+				c.pi        = pi.template cast<int_t>();
+				c.halfPi    = c.pi >> 1;
+				c.quarterPi = c.pi >> 2;
+
+				// ln 2 = 2 atanh(1/3), log(j/32) = 2 atanh((j - 32) / (j + 32))
+				c.ln2 = (atanSeries (one / series_t(3), true) << 1).template cast<int_t>();
+				for (int j = 16; j <= 32; j++)
+					c.logTable[j - 16] = atanSeries ((series_t(j - 32) << frac_bits) / series_t(j + 32), true) << 1;
+
+				for (size_t j = 0; j < 14; j++)
+					sinCosSeries (ratio (j, 4), c.sinTable[j], c.cosTable[j]);
+
+				// atan(j/16) = atan((j-1)/16) + atan(16 / (256 + j(j-1)))
+				c.atanTable[0] = 0;
+				for (int j = 1; j <= 16; j++)
+					c.atanTable[j] = c.atanTable[j - 1] + atanSeries ((series_t(16) << frac_bits) / series_t(256 + j * (j - 1)), false);
+
+				c.expCoefs = factorialCoefs ((c.ln2 >> expSquarings()).template cast<series_t>());
+
+				std::vector<series_t> coefs = factorialCoefs (ratio (1, 5));
+				for (size_t k = 0; k < coefs.size(); k++)
+				{
+					std::vector<series_t>& target = (k & 1) ? c.sinCoefs : c.cosCoefs;
+					target.push_back (((k >> 1) & 1) ? -coefs[k] : coefs[k]);
+				}
+
+				c.atanCoefs  = oddCoefs (ratio (1, 5), true);
+				c.atanhCoefs = oddCoefs (ratio (1, 6), false);
+
+				return c;
+			}
+
+			static const constants_t& constants ()
+			{
+				static const constants_t c = makeConstants();
+				return c;
+			}
+
+	// ==============================================================
+	//      Roots
+	// ==============================================================
+
+		public:
+			static bigfixed_t sqrt (const bigfixed_t& x)
+			{
+				if (x.isNegative())
+					throw std::out_of_range("Argument Out Of Range");
+
+				// sqrt(X / 2^F) = sqrt(X 2^F) / 2^F
+				typedef bigint<bigfixed_t::size_words + bigfixed_t::size_words_frac, false> root_t;
+				root_t m = x.m_internalValue.template cast<root_t>() << bigfixed_t::size_bits_frac;
+
+				return bigfixed_t(isqrt (m).template cast<internal_t>());
+			}
+
+			// wraps if 1/sqrt(x) is out of range
+			static bigfixed_t rsqrt (const bigfixed_t& x)
+			{
+				if (x.isNegative() || x.m_internalValue == 0)
+					throw std::out_of_range("Argument Out Of Range");
+
+				// 2^F / sqrt(X / 2^F) = sqrt(2^3F / X), and the floors commute
+				const size_t words = 3 * bigfixed_t::size_words_frac + 1;
+				typedef bigint<(words > bigfixed_t::size_words ? words : bigfixed_t::size_words) + 1, false> root_t;
+				root_t m = (root_t(1) << (3 * bigfixed_t::size_bits_frac)) / x.m_internalValue.template cast<root_t>();
+
+				return bigfixed_t(isqrt (m).template cast<internal_t>());
+			}
+
+	// ==============================================================
+	//      Exponential and logarithm
+	// ==============================================================
+
+			static bigfixed_t exp (const bigfixed_t& x)
+			{
+				const constants_t& c = constants();
+				int_t value = toWork (x);
+
+				// x = k ln2 + r, |r| < ln2
+				int_t k = value / c.ln2;
+				int_t r = value - k * c.ln2;
+
+				if (k >= int_t(int(bigfixed_t::size_bits_whole - 1)))
+					throw std::out_of_range("Result Out Of Range");
+				if (k < -int_t(int(frac_bits)))
+					return bigfixed_t();
+
+				size_t s = expSquarings();
+				series_t sum = horner (c.expCoefs, (r >> s).template cast<series_t>());
+
+				for (size_t i = 0; i < s; i++)
+					sum = mul (sum, sum);
+
+				int shift = int(k.getWord(0));
+				int_t result = sum.template cast<int_t>();
+				return fromWork (shift >= 0 ? result << shift : result >> -shift);
+			}
+
+			static bigfixed_t log (const bigfixed_t& x)
+			{
+				if (x.isNegative() || x.m_internalValue == 0)
+					throw std::out_of_range("Argument Out Of Range");
+
+				const constants_t& c = constants();
+				int_t value = toWork (x);
+
+				// x = 2^k m, m in [1/2, 1), and a = j/32 the nearest tabled point to m
+				int k = int(value.indexMSB() + 1) - int(frac_bits);
+				series_t m = (k >= 0 ? value >> k : value << -k).template cast<series_t>();
+				size_t j = nearest (m, 5);
+				series_t a = ratio (j, 5);
+
+				// log(m / a) = 2 atanh((m - a) / (m + a)), |z| <= 1/64
+				series_t z = div (m - a, m + a);
+				series_t logm = c.logTable[j - 16] + (mul (z, horner (c.atanhCoefs, mul (z, z))) << 1);
+
+				return fromWork (logm.template cast<int_t>() + c.ln2 * int_t(k));
+			}
+
+	// ==============================================================
+	//      Trigonometric
+	// ==============================================================
+
+			static void sincos (const bigfixed_t& x, bigfixed_t& sinx, bigfixed_t& cosx)
+			{
+				const constants_t& c = constants();
+				int_t value = toWork (x);
+
+				// x = k pi/2 + r, |r| <= pi/4
+				int_t k = (value + (value.isNegative() ? -c.quarterPi : c.quarterPi)) / c.halfPi;
+				series_t r = (value - k * c.halfPi).template cast<series_t>();
+
+				// |r| = a + t, a = j/16 tabled, |t| <= 1/32
+				bool neg = r.isNegative();
+				if (neg)
+					r = -r;
+
+				size_t j = nearest (r, 4);
+				series_t t  = r - ratio (j, 4);
+				series_t t2 = mul (t, t);
+				series_t sint = mul (t, horner (c.sinCoefs, t2));
+				series_t cost = horner (c.cosCoefs, t2);
+
+				series_t s  = mul (c.sinTable[j], cost) + mul (c.cosTable[j], sint);
+				series_t co = mul (c.cosTable[j], cost) - mul (c.sinTable[j], sint);
+				if (neg)
+					s = -s;
+
+				switch (k.getWord(0) & 3)
+				{
+					case 0: sinx = fromWork (s);   cosx = fromWork (co);  break;
+					case 1: sinx = fromWork (co);  cosx = fromWork (-s);  break;
+					case 2: sinx = fromWork (-s);  cosx = fromWork (-co); break;
+					case 3: sinx = fromWork (-co); cosx = fromWork (s);   break;
+				}
+			}
+
+			static bigfixed_t atan (const bigfixed_t& x)
+			{
+				const constants_t& c = constants();
+				int_t value = toWork (x);
+
+				bool neg = value.isNegative();
+				if (neg)
+					value = -value;
+
+				// atan(v) = pi/2 - atan(1/v)
+				bool inverted = value > one<int_t>();
+				if (inverted)
+					value = div (one<int_t>(), value);
+
+				// atan(v) = atan(a) + atan((v - a) / (1 + v a)), a = j/16 tabled, |t| <= 1/32
+				series_t v = value.template cast<series_t>();
+				size_t j = nearest (v, 4);
+				series_t a = ratio (j, 4);
+				series_t t = div (v - a, one<series_t>() + mul (v, a));
+				int_t result = (c.atanTable[j] + mul (t, horner (c.atanCoefs, mul (t, t)))).template cast<int_t>();
+
+				if (inverted)
+					result = c.halfPi - result;
+
+				return fromWork (neg ? -result : result);
+			}
+
+			static bigfixed_t pi ()
+			{
+				return fromWork (constants().pi);
+			}
+
+			static bigfixed_t ln2 ()
+			{
+				return fromWork (constants().ln2);
+			}
+	};
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> sqrt (const bigfixed<numwords, numwords_frac>& x)
+	{
+		return fixed_functions< bigfixed<numwords, numwords_frac> >::sqrt (x);
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> rsqrt (const bigfixed<numwords, numwords_frac>& x)
+	{
+		return fixed_functions< bigfixed<numwords, numwords_frac> >::rsqrt (x);
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> exp (const bigfixed<numwords, numwords_frac>& x)
+	{
+		return fixed_functions< bigfixed<numwords, numwords_frac> >::exp (x);
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> log (const bigfixed<numwords, numwords_frac>& x)
+	{
+		return fixed_functions< bigfixed<numwords, numwords_frac> >::log (x);
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> sin (const bigfixed<numwords, numwords_frac>& x)
+	{
+		bigfixed<numwords, numwords_frac> sinx, cosx;
+		fixed_functions< bigfixed<numwords, numwords_frac> >::sincos (x, sinx, cosx);
+		return sinx;
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> cos (const bigfixed<numwords, numwords_frac>& x)
+	{
+		bigfixed<numwords, numwords_frac> sinx, cosx;
+		fixed_functions< bigfixed<numwords, numwords_frac> >::sincos (x, sinx, cosx);
+		return cosx;
+	}
+
+	template <size_t numwords, size_t numwords_frac>
+	bigfixed<numwords, numwords_frac> atan (const bigfixed<numwords, numwords_frac>& x)
+	{
+		return fixed_functions< bigfixed<numwords, numwords_frac> >::atan (x);
+	}
+}
@@ -1,81 +1,146 @@
 #pragma once
 
 #include <string>
+#include <cstring>
+#include <charconv>
+#include <span>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+#include <system_error>
 #include <algorithm>
 #include <stdexcept>
 #include <ctype.h>
 
 #include "mathprimatives.h"
+#include "kernels.h"
+#include "hexcodec.h"
 
 namespace bignum
 {
-	template <size_t numwords, bool issigned>
+	template <typename bigint_t> class montgomery_context;
+	template <typename bigint_t> class division_context;
+	template <typename bigint_t> class euclid;
+
+	// limb type used by the add, sub and multiply kernels: 64 bit where the
+	// compiler has a 64x64->128 bit multiply and the width is a whole number
+	// of 64 bit limbs, otherwise 32 bit
+#ifndef BIGNUM_LIMB64
+#define BIGNUM_LIMB64 MATHPRIM_NATIVE_MUL64
+#endif
+
+	template <bool limb64>
+	struct limb_select
+	{
+		typedef mathprim::u32 type;
+	};
+
+	template <>
+	struct limb_select<true>
+	{
+		typedef mathprim::u64 type;
+	};
+
+	template <size_t numwords>
+	struct default_limb : limb_select<BIGNUM_LIMB64 && numwords % 2 == 0>
+	{
+	};
+
+	// leading zeros written by to_chars
+	enum class digits_format
+	{
+		minimal,		// none, as std::to_chars
+		full_width		// padded to the widest value of the type
+	};
+
+	template <size_t numwords, bool issigned, typename limb_t = typename default_limb<numwords>::type>
 	class bigint
 	{
 		public:
-			typedef bigint <numwords, issigned> this_t;
+			typedef bigint <numwords, issigned, limb_t> this_t;
+			typedef limb_t limb_type;
+			typedef bigint <2 * numwords, issigned, limb_t> wide_t;		// holds a full product
 			static const size_t size_bits  = numwords * 32;
 			static const size_t size_words = numwords;
+			static const size_t size_bytes = numwords * 4;
+			static const size_t size_limbs = numwords * 4 / sizeof(limb_t);
 			static const bool is_signed = issigned;
 
-		private:
-			template <size_t numwords2, bool issigned2> friend class bigint;
+			static_assert (sizeof(limb_t) == 4 || (sizeof(limb_t) == 8 && numwords % 2 == 0), "64 bit limbs need an even number of words");
 
-			// m_words[0] == LSW, m_words[numwords-1] = MSW
-			mathprim::u32 m_words[numwords];
+		private:
+			template <size_t numwords2, bool issigned2, typename limb2_t> friend class bigint;
+			template <typename bigint_t> friend class montgomery_context;
+			template <typename bigint_t> friend class division_context;
+			template <typename bigint_t> friend class euclid;
+
+			// m_words[0] == LSW, m_words[numwords-1] = MSW. m_limbs is the same
+			// little endian storage viewed as limb_t for the add / sub / mul kernels.
+			// Only m_words is ever active during constant evaluation, where reading
+			// the other member of a union is an error, so the functions that use
+			// m_limbs fall back to the word kernels there
+			union
+			{
+				mathprim::u32 m_words[numwords] = {};
+				limb_t m_limbs[size_limbs];
+			};
 
 			// ==============================================================
 			//      Utility Functions
 			// ==============================================================
+			//
+			// result may alias any of the operands. The multiplies and divides build
+			// their result in a temporary for that, as their kernels read inputs after
+			// writing outputs; everything else runs in place in a single pass
 
 		public:
-			static void add (const this_t& a, const this_t& b, this_t& result) 
+			static constexpr void add (const this_t& a, const this_t& b, this_t& result) 
 			{
-				mathprim::u32 carry = 0;
-				for (int n = 0; n < numwords; n++)
-					result.m_words[n] = mathprim::addWithCarry(a.m_words[n], b.m_words[n], carry);
+				if (std::is_constant_evaluated())
+					kernels::add(result.m_words, a.m_words, b.m_words, numwords);
+				else
+					kernels::add(result.m_limbs, a.m_limbs, b.m_limbs, size_limbs);
 			}
 
-			static void sub (const this_t& a, const this_t& b, this_t& result) 
+			static constexpr void sub (const this_t& a, const this_t& b, this_t& result) 
 			{
-				this_t b_neg;
-				twosComplement(b, b_neg);
-				add (a, b_neg, result);
+				if (std::is_constant_evaluated())
+					kernels::sub(result.m_words, a.m_words, b.m_words, numwords);
+				else
+					kernels::sub(result.m_limbs, a.m_limbs, b.m_limbs, size_limbs);
 			}
 
 			// result = a << 32;
-			static void shiftLeft32Bit (const this_t& a, this_t& result) 
+			static constexpr void shiftLeft32Bit (const this_t& a, this_t& result) 
 			{
 				for (int n = numwords - 2; n >= 0; n--)
 					result.m_words[n + 1] = a.m_words[n];
 				result.m_words[0] = 0;	
 			}
 
-			// result = a << bits;
-			static void shiftLeft (const this_t& a, size_t bits, this_t& result) 
+			// result = a << bits in one pass from the top word down: word offset bits / 32,
+			// then the bit remainder taken from each pair of source words. Every source word
+			// is read before the result word at the same index is written, so result may
+			// alias a
+			static constexpr void shiftLeft (const this_t& a, size_t bits, this_t& result) 
 			{
-				this_t val = a;
+				size_t offset = std::min(bits / 32, numwords);
+				size_t shift = bits % 32;
 
-				for (;bits >= 32; bits -= 32)
-					shiftLeft32Bit (val, val);
-
-				if (bits)
+				for (size_t n = numwords; n-- > offset;)
 				{
-					for (int n = numwords - 1; n >= 0; n--)
-					{
-						mathprim::compound_u64 v = mathprim::LSL(val.m_words[n], bits);
-						val.m_words[n] = v.lo;
-
-						if (n != numwords - 1)
-							val.m_words[n+1] |= v.hi;
-					}
+					mathprim::u32 word = a.m_words[n - offset] << shift;
+					if (shift && n > offset)
+						word |= a.m_words[n - offset - 1] >> (32 - shift);
+					result.m_words[n] = word;
 				}
 
-				result = val;
+				for (size_t n = 0; n < offset; n++)
+					result.m_words[n] = 0;
 			}
 
 			// result = a >> 32 (unsigned shift);
-			static void shiftRight32BitUnsigned (const this_t& a, this_t& result) 
+			static constexpr void shiftRight32BitUnsigned (const this_t& a, this_t& result) 
 			{
 				for (int n = 1; n < numwords; n++)
 					result.m_words[n - 1] = a.m_words[n];
@@ -83,7 +148,7 @@ namespace bignum
 			}
 
 			// result = a >> 32 (signed shift - sign bit extended);
-			static void shiftRight32BitSigned (const this_t& a, this_t& result) 
+			static constexpr void shiftRight32BitSigned (const this_t& a, this_t& result) 
 			{
 				bool isNeg = a.isNegative();
 				
@@ -91,111 +156,187 @@ namespace bignum
 				result.m_words[numwords - 1] = isNeg?mathprim::u32(-1):0;
 			}
 
-			static void shiftRightSigned (const this_t& a, size_t bits, this_t& result) 
-			{			
-				this_t val = a;
-
-				for (;bits >= 32; bits -= 32)
-					shiftRight32BitSigned (val, val);
-
-				if (bits)
-				{
-					for (int n = 0; n < numwords - 1; n++)
-					{
-						mathprim::compound_u64 v = mathprim::LSR(val.m_words[n], bits);
-						val.m_words[n] = v.hi;
-
-						if (n != 0)
-							val.m_words[n-1] |= v.lo;
-					}
-					mathprim::compound_u64 v = mathprim::ASR(val.m_words[numwords - 1], bits);
-					val.m_words[numwords - 1] = v.hi;
-					val.m_words[numwords - 2] |= v.lo;
-				}
-				result = val;
+			// result = a >> bits, the sign bit extended. One pass from the bottom up, result may alias a
+			static constexpr void shiftRightSigned (const this_t& a, size_t bits, this_t& result) 
+			{
+				shiftRight (a, bits, a.isNegative() ? mathprim::u32(-1) : 0, result);
 			}
 
-			static void shiftRightUnsigned (const this_t& a, size_t bits, this_t& result) 
+			// result = a >> bits, zero filled. One pass from the bottom up, result may alias a
+			static constexpr void shiftRightUnsigned (const this_t& a, size_t bits, this_t& result) 
 			{
-				this_t val = a;
-
-				for (;bits >= 32; bits -= 32)
-					shiftRight32BitUnsigned (val, val);
-
-				if (bits)
-				{
-					for (int n = 0; n < numwords; n++)
-					{
-						mathprim::compound_u64 v = mathprim::LSR(val.m_words[n], bits);
-						val.m_words[n] = v.hi;
-
-						if (n != 0)
-							val.m_words[n-1] |= v.lo;
-					}
-				}
-				result = val;
+				shiftRight (a, bits, 0, result);
 			}
 
-			static void and (const this_t& a, const this_t& b, this_t& result) 
+			static constexpr void and (const this_t& a, const this_t& b, this_t& result) 
 			{
 				for (int n = 0; n < numwords; n++)
 					result.m_words[n] = a.m_words[n] & b.m_words[n];
 			}
 
-			static void or (const this_t& a, const this_t& b, this_t& result) 
+			static constexpr void or (const this_t& a, const this_t& b, this_t& result) 
 			{
 				for (int n = 0; n < numwords; n++)
 					result.m_words[n] = a.m_words[n] | b.m_words[n];
 			}
 
-			static void xor (const this_t& a, const this_t& b, this_t& result) 
+			static constexpr void xor (const this_t& a, const this_t& b, this_t& result) 
 			{
 				for (int n = 0; n < numwords; n++)
 					result.m_words[n] = a.m_words[n] ^ b.m_words[n];
 			}
 
-			static void onesCompliment (const this_t& a, this_t& result) 
+			static constexpr void onesCompliment (const this_t& a, this_t& result) 
 			{
 				for (int n = 0; n < numwords; n++)
 					result.m_words[n] = ~a.m_words[n];
 			}
 
-			static void smul (const this_t& a, const this_t& b, this_t& result) 
+			// the low numwords of a two's complement product are the same whether the
+			// operands are treated as signed or unsigned, so the wrapping result is umul's 
+			static constexpr void smul (const this_t& a, const this_t& b, this_t& result) 
 			{
-				bool aneg = a.isNegative();
-				bool bneg = b.isNegative();
+				umul (a, b, result);
+			}
 
-				this_t a2 = aneg?-a:a;
-				this_t b2 = bneg?-b:b;
+			// low numwords of a * b. Product scanning (Comba) on limb_t below
+			// BIGNUM_KARATSUBA_THRESHOLD words, Karatsuba / Toom-3 / NTT on 32 bit words above.
+			// When the significant limbs of the operands leave high columns of the
+			// product empty only the occupied columns are formed, so two values
+			// under 2^64 cost one hardware multiply whatever the width.
+			static constexpr void umul (const this_t& a, const this_t& b, this_t& result) 
+			{
+				this_t res;		// result may alias a or b
+
+				if (std::is_constant_evaluated())
+				{
+					mathprim::u32 scratch[kernels::mul_scratch<numwords>::words];
+					kernels::mulLow(res.m_words, a.m_words, b.m_words, numwords, scratch);
+					result = res;
+					return;
+				}
 
-				umul (a2, b2, result);
+				size_t na = kernels::significantWords(a.m_limbs, size_limbs);
+				size_t nb = kernels::significantWords(b.m_limbs, size_limbs);
 
-				if (aneg != bneg)
-					this_t::twosComplement(result, result);
+				// above the threshold only while the shorter operand is basecase sized
+				bool sparse = na + nb <= size_limbs && (numwords < BIGNUM_KARATSUBA_THRESHOLD || std::min(na, nb) * sizeof(limb_t) / 4 < BIGNUM_KARATSUBA_THRESHOLD);
+
+				if (sparse)
+				{
+					kernels::mulLowBasecase(res.m_limbs, a.m_limbs, na, b.m_limbs, nb, size_limbs);
+				}
+				else if (numwords < BIGNUM_KARATSUBA_THRESHOLD)
+				{
+					kernels::mulLowBasecase(res.m_limbs, a.m_limbs, b.m_limbs, size_limbs);
+				}
+				else
+				{
+					mathprim::u32 scratch[kernels::mul_scratch<numwords>::words];
+					kernels::mulLow(res.m_words, a.m_words, b.m_words, numwords, scratch);
+				}
+
+				result = res;
 			}
 
-			static void umul (const this_t& a, const this_t& b, this_t& result) 
+			// result = low numwords of a * b + c. Below BIGNUM_KARATSUBA_THRESHOLD words
+			// the rows of the product are added straight onto c, so there is no product
+			// temporary and no separate addition pass; above it the product comes from
+			// umul. result may alias any operand, and likewise for the functions below
+			static constexpr void mulAdd (const this_t& a, const this_t& b, const this_t& c, this_t& result) 
 			{
-				this_t res = 0;
-				for (int n = 0; n < numwords; n++)
-				{
-					for (int m = 0; m < numwords; m++)
-					{
-						if (a.m_words[n] == 0 || b.m_words[m] == 0) 
-							continue;
+				mulAddSub (a, b, c, false, result);
+			}
 
-						mathprim::compound_u64 x = mathprim::mul32x32(a.m_words[n], b.m_words[m]);
-						this_t part (x.u64_value);
-						shiftLeft (part, (n + m) * 32, part);
-						add (res, part, res);
-					}
+			// result = a * b - c, the rows are added onto -c
+			static constexpr void mulSub (const this_t& a, const this_t& b, const this_t& c, this_t& result) 
+			{
+				mulAddSub (a, b, c, true, result);
+			}
+
+			// result += a * b
+			static constexpr void addMul (const this_t& a, const this_t& b, this_t& result) 
+			{
+				mulAddSub (a, b, result, false, result);
+			}
+
+			// result = a[0] * b[0] + .. + a[count - 1] * b[count - 1], every product
+			// accumulated in place into one sum
+			static constexpr void sumOfProducts (const this_t* a, const this_t* b, size_t count, this_t& result) 
+			{
+				this_t res;		// result may alias an element of a or b
+
+				for (size_t j = 0; j < count; j++)
+				{
+					if (numwords >= BIGNUM_KARATSUBA_THRESHOLD)
+						addMul (a[j], b[j], res);
+					else if (std::is_constant_evaluated())
+						kernels::addMulLowBasecase(res.m_words, a[j].m_words, b[j].m_words, numwords);
+					else
+						kernels::addMulLowBasecase(res.m_limbs, a[j].m_limbs, b[j].m_limbs, size_limbs);
 				}
 
 				result = res;
 			}
 
+			// the full 2 * numwords product of a and b, signed or unsigned as the type. Only
+			// the columns the operands' significant limbs reach are formed, and no operand
+			// is widened first
+			static constexpr wide_t mulFull (const this_t& a, const this_t& b) 
+			{
+				wide_t result;
+				umulFull (a, b, result);
+
+				// a two's complement operand x stands for x - 2^size_bits, so take the
+				// other operand off the top half once for each negative one
+				if (issigned && a.isNegative())
+					kernels::sub(result.m_words + numwords, result.m_words + numwords, b.m_words, numwords);
+				if (issigned && b.isNegative())
+					kernels::sub(result.m_words + numwords, result.m_words + numwords, a.m_words, numwords);
+
+				return result;
+			}
+
+			// the top numwords of the full product (a * b) >> size_bits. The low columns
+			// are still formed, for their carries, but never stored
+			static constexpr this_t mulHigh (const this_t& a, const this_t& b) 
+			{
+				wide_t full = mulFull (a, b);
+
+				this_t result;
+				kernels::copy(result.m_words, full.m_words + numwords, numwords);
+				return result;
+			}
+
+			// the low numwords of a * b, as operator*
+			static constexpr this_t mulLow (const this_t& a, const this_t& b) 
+			{
+				this_t result;
+				umul (a, b, result);
+				return result;
+			}
+
+			// result = low numwords of a * b, as umul. Returns true if the unsigned product
+			// did not fit. The bit lengths settle that without the high half unless they
+			// sum to exactly size_bits + 1, when the product is formed in full once
+			static constexpr bool umulOverflow (const this_t& a, const this_t& b, this_t& result) 
+			{
+				size_t bits = (a.indexMSB() + 1) + (b.indexMSB() + 1);
+
+				if (bits != size_bits + 1)
+				{
+					umul (a, b, result);
+					return bits > size_bits;
+				}
+
+				wide_t full;
+				umulFull (a, b, full);
+				kernels::copy(result.m_words, full.m_words, numwords);
+				return kernels::significantWords(full.m_words + numwords, numwords) != 0;
+			}
+
 			// result = dividend/divisor  - signed
-			static void sdiv (const this_t& a, const this_t& b, this_t& result, this_t& modulo) 
+			static constexpr void sdiv (const this_t& a, const this_t& b, this_t& result, this_t& modulo) 
 			{
 				bool aneg = a.isNegative();
 				bool bneg = b.isNegative();
@@ -209,94 +350,112 @@ namespace bignum
 					this_t::twosComplement(result, result);
 			}
 
-			// result = dividend/divisor  - unsigned
-			static void udiv (const this_t& dividend, const this_t& divisor, this_t& result, this_t& modulo) 
+			// result = dividend/divisor  - unsigned. Knuth algorithm D over the significant words
+			// of the operands, or a single word divide when the divisor fits in one word
+			static constexpr void udiv (const this_t& dividend, const this_t& divisor, this_t& result, this_t& modulo) 
 			{
-				this_t quotient(0);
-				this_t temp(0);
-
 				if (divisor == 0) 
 					throw std::invalid_argument("Divide By Zero");
-	            
-				for (int n = size_bits - 1; n >= 0; n--)
-				{
-					temp <<= 1;
-					temp.setBit(0, dividend.getBit(n));
 
-					if (temp >= divisor)
-					{
-						quotient.setBit(n, true);
-						temp -= divisor;
-					}
+				size_t n = kernels::significantWords(dividend.m_words, numwords);
+				size_t m = kernels::significantWords(divisor.m_words, numwords);
+
+				this_t quotient(0);
+				this_t remainder(0);	// result and modulo may alias dividend or divisor
+
+				if (n < m)
+				{
+					remainder = dividend;
+				}
+				else if (n <= 2)
+				{
+					// both under 2^64, one hardware divide
+					mathprim::u64 x = dividend.low64();
+					mathprim::u64 d = divisor.low64();
+					quotient = this_t((unsigned __int64)(x / d));
+					remainder = this_t((unsigned __int64)(x % d));
+				}
+				else if (m == 1)
+				{
+					remainder.m_words[0] = kernels::divmod1(quotient.m_words, dividend.m_words, n, divisor.m_words[0]);
+				}
+				else
+				{
+					mathprim::u32 scratch[2 * numwords + 1];
+					kernels::divmod(quotient.m_words, remainder.m_words, dividend.m_words, n, divisor.m_words, m, scratch);
 				}
 
-				modulo = temp;
+				modulo = remainder;
 				result = quotient;
 			}
 
-	//         static void udivBy10 (const this_t& a, this_t& result) 
-	//         {
-	//             unsigned q, r;
-	//             q = (a >> 1) + (a >> 2);
-	//             q = q + (q >> 4);
-	//             q = q + (q >> 8);
-	//             q = q + (q >> 16);
-	//             q = q >> 3;
-	//             r = a - q*10;
-	//             return q + ((r + 6) >> 4);
-	//         }
-
-			static void udivBy10 (const this_t& a, this_t& result) 
+			// result = dividend/divisor where divisor is known to divide dividend exactly. 
+			// Cheaper than udiv/sdiv as no quotient estimates are needed; the result is 
+			// meaningless if there is a remainder.
+			static constexpr void divexact (const this_t& dividend, const this_t& divisor, this_t& result) 
 			{
-				this_t q;
-				this_t r;
-				this_t temp;
+				if (divisor == 0) 
+					throw std::invalid_argument("Divide By Zero");
+
+				bool aneg = issigned && dividend.isNegative();
+				bool bneg = issigned && divisor.isNegative();
+
+				this_t a = aneg?-dividend:dividend;
+				this_t d = bneg?-divisor:divisor;
+
+				// make the divisor odd, the dividend has at least as many low zero bits
+				size_t zeros = kernels::trailingZeroBits(d.m_words, numwords);
+				shiftRightUnsigned(a, zeros, a);
+				shiftRightUnsigned(d, zeros, d);
 
-				shiftRightSigned(a, 1, q);
-				shiftRightSigned(a, 2, temp);
-				add (q, temp, q);
+				size_t n = kernels::significantWords(a.m_words, numwords);
+				size_t m = kernels::significantWords(d.m_words, numwords);
 
-				size_t shiftval = 4;
-				for (int n = 0; n < numwords * 3; n++)
+				// the quotient fits in n - m + 1 words, so only that many are computed
+				this_t quotient(0);
+				if (n >= m)
 				{
-					shiftRightSigned(q, shiftval, temp);
-					add (q, temp, q);
-					shiftval *= 2;
+					mathprim::u32 scratch[numwords];
+					kernels::divexact(quotient.m_words, a.m_words, n - m + 1, d.m_words, m, scratch);
 				}
 
-				shiftRightSigned(q, 3, q);
+				if (aneg != bneg)
+					this_t::twosComplement(quotient, quotient);
 
-				umul (q, 10, temp);
-				sub (a, temp, r);
-				
-				add (r, 6, r);
-				shiftRightSigned(r, 4, r);
+				result = quotient;
+			}
 
-				add (q, r, result);
+			// result = a / 10 (unsigned), by multiplying with the precomputed reciprocal of 10.
+			// One pass from the top word down, result may alias a
+			static constexpr void udivBy10 (const this_t& a, this_t& result) 
+			{
+				kernels::divmod1Preinv(result.m_words, a.m_words, numwords, divc<10>::normalized, divc<10>::shift, divc<10>::reciprocal);
 			}
 			
-			static void mulBy10 (const this_t& a, this_t& result) 
+			// result = a * 10, one single word multiply pass. result may alias a
+			static constexpr void mulBy10 (const this_t& a, this_t& result) 
 			{
-				this_t temp;
-				shiftLeft(a, 3, temp);
-				add (a, temp, temp);
-				add (a, temp, result);
+				kernels::mul1(result.m_words, a.m_words, numwords, 10);
 			}
 
-			// return < 0 if a < b;  0 if a == b; > 0 if a > b 
-			static int unsignedCompare (const this_t& a, const this_t& b) 
+			// return < 0 if a < b;  0 if a == b; > 0 if a > b. Whole limbs from the top,
+			// so the equal zero limbs above small values are passed two words at a time
+			static constexpr int unsignedCompare (const this_t& a, const this_t& b) 
 			{
-				for (int n = numwords - 1; n >= 0; n--)
+				if (std::is_constant_evaluated())
+					return kernels::compare(a.m_words, b.m_words, numwords);
+
+				for (size_t n = size_limbs; n-- > 0;)
 				{
-					if (a.m_words[n] < b.m_words[n]) return -1;
-					if (a.m_words[n] > b.m_words[n]) return 1;
+					if (a.m_limbs[n] != b.m_limbs[n])
+						return a.m_limbs[n] < b.m_limbs[n] ? -1 : 1;
 				}
 
 				return 0;
 			}
 
 			// return < 0 if a < b;  0 if a == b; > 0 if a > b 
-			static int signedCompare (const this_t& a, const this_t& b) 
+			static constexpr int signedCompare (const this_t& a, const this_t& b) 
 			{
 				bool a_neg = a.isNegative();
 				bool b_neg = b.isNegative();
@@ -307,10 +466,86 @@ namespace bignum
 				return unsignedCompare(a, b);
 			}
 
-			static void twosComplement (const this_t& a, this_t& result) 
+			// result = -a, complement and increment in one pass. result may alias a
+			static constexpr void twosComplement (const this_t& a, this_t& result) 
 			{
-				onesCompliment (a, result);	
-				add (result, mathprim::u32(1), result);
+				if (std::is_constant_evaluated())
+					kernels::negate(result.m_words, a.m_words, numwords);
+				else
+					kernels::negate(result.m_limbs, a.m_limbs, size_limbs);
+			}
+
+		private:
+			// the low 64 bits, for the under 2^64 fast paths; single word types have no word 1
+			constexpr mathprim::u64 low64 () const
+			{
+				if (numwords == 1)
+					return m_words[0];
+
+				return (mathprim::u64(m_words[1]) << 32) | m_words[0];
+			}
+
+			// result = the unsigned 2 * numwords product of a and b. As umul, a basecase
+			// sized operand keeps to the bounded basecase above the threshold
+			static constexpr void umulFull (const this_t& a, const this_t& b, wide_t& result) 
+			{
+				size_t na = std::is_constant_evaluated() ? numwords : kernels::significantWords(a.m_limbs, size_limbs);
+				size_t nb = std::is_constant_evaluated() ? numwords : kernels::significantWords(b.m_limbs, size_limbs);
+
+				if (std::is_constant_evaluated() || (numwords >= BIGNUM_KARATSUBA_THRESHOLD && std::min(na, nb) * sizeof(limb_t) / 4 >= BIGNUM_KARATSUBA_THRESHOLD))
+				{
+					mathprim::u32 scratch[kernels::mul_scratch<numwords>::words];
+					kernels::mul(result.m_words, a.m_words, b.m_words, numwords, scratch);
+					return;
+				}
+
+				if (na < size_limbs || nb < size_limbs)
+					kernels::mulLowBasecase(result.m_limbs, a.m_limbs, na, b.m_limbs, nb, 2 * size_limbs);
+				else
+					kernels::mulBasecase(result.m_limbs, a.m_limbs, b.m_limbs, size_limbs);
+			}
+
+			static constexpr void mulAddSub (const this_t& a, const this_t& b, const this_t& c, bool subtract, this_t& result) 
+			{
+				this_t res = c;		// result may alias a or b
+				if (subtract)
+					twosComplement (res, res);
+
+				if (numwords >= BIGNUM_KARATSUBA_THRESHOLD)
+				{
+					this_t product;
+					umul (a, b, product);
+					add (res, product, res);
+				}
+				else if (std::is_constant_evaluated())
+				{
+					kernels::addMulLowBasecase(res.m_words, a.m_words, b.m_words, numwords);
+				}
+				else
+				{
+					kernels::addMulLowBasecase(res.m_limbs, a.m_limbs, b.m_limbs, size_limbs);
+				}
+
+				result = res;
+			}
+
+			// result = a >> bits with fill standing in for the words above a. Word n
+			// of the result only reads words n and up, so it is written bottom up
+			static constexpr void shiftRight (const this_t& a, size_t bits, mathprim::u32 fill, this_t& result) 
+			{
+				size_t offset = std::min(bits / 32, numwords);
+				size_t shift = bits % 32;
+
+				for (size_t n = 0; n + offset < numwords; n++)
+				{
+					mathprim::u32 word = a.m_words[n + offset] >> shift;
+					if (shift)
+						word |= (n + offset + 1 < numwords ? a.m_words[n + offset + 1] : fill) << (32 - shift);
+					result.m_words[n] = word;
+				}
+
+				for (size_t n = numwords - offset; n < numwords; n++)
+					result.m_words[n] = fill;
 			}
 
 		public: 
@@ -319,13 +554,11 @@ namespace bignum
 	//      Construction
 	// ==============================================================
 
-			bigint ()
+			constexpr bigint ()
 			{
-				for (int n = 0; n < numwords; n++)
-					m_words[n] = 0;
 			}
 
-			bigint (int value)
+			constexpr bigint (int value)
 			{
 				if (value < 0)
 				{
@@ -338,7 +571,7 @@ namespace bignum
 				}
 			}
 
-			bigint (__int64 value)
+			constexpr bigint (__int64 value)
 			{
 				if (value < 0)
 				{
@@ -352,20 +585,18 @@ namespace bignum
 			}
 
 
-			bigint (unsigned int value)
+			constexpr bigint (unsigned int value)
 			{
 				m_words[0] = value;
 				for (int n = 1; n < numwords; n++)
 					m_words[n] = 0;
 			}
 
-			bigint (unsigned __int64 value)
+			constexpr bigint (unsigned __int64 value)
 			{
-				mathprim::compound_u64 cvalue; 
-				cvalue.u64_value = value;
-
-				m_words[0] = cvalue.lo;
-				m_words[1] = cvalue.hi;
+				m_words[0] = mathprim::u32(value);
+				if (numwords > 1)
+					m_words[1] = mathprim::u32(value >> 32);
 				for (int n = 2; n < numwords; n++)
 					m_words[n] = 0;
 			}
@@ -375,7 +606,7 @@ namespace bignum
 	// ==============================================================
 
 			template < typename new_bigint_t >
-			new_bigint_t cast ()
+			constexpr new_bigint_t cast () const
 			{
 				new_bigint_t result;
 
@@ -393,52 +624,63 @@ namespace bignum
 				return result;
 			}
 
-			std::string toDecString () const
+			// largest number of characters to_chars can write in base 10 or 16, sign included
+			template <int base>
+			static constexpr size_t maxCharsFor ()
 			{
-				std::string out;
+				static_assert (base == 10 || base == 16, "Only bases 10 and 16 are supported");
+				return (base == 16 ? numwords * 8 : size_bits * 30103 / 100000 + 1) + (issigned ? 1 : 0);
+			}
 
-				if (*this == 0) return "0";
+			// number of digits in the magnitude, without sign or leading zeros
+			size_t digitCount (int base = 10) const
+			{
+				bool neg = issigned && isNegative();
+				this_t value = neg?-*this:*this;
 
-				bool neg = isNegative();
+				size_t bits = value.indexMSB() + 1;
+				if (bits == 0)
+					return 1;
 
-				this_t temp = neg?-*this:*this;
-				this_t temp2 = temp;
+				if (base == 16)
+					return (bits + 3) / 4;
 
-				while (temp != 0)
-				{
-					udivBy10(temp, temp);
-					mathprim::u32 mod10 = (temp2 - (temp * 10)).m_words[0]; 
-					out += ('0' + mod10);
-					temp2 = temp;
-				}
+				if (base != 10)
+					throw std::invalid_argument("Only Bases 10 And 16 Are Supported");
 
-				if (neg) out += '-';
-				
-				std::reverse (out.begin(), out.end());
-				return out;
-			}
+				// 2^(bits-1) <= value < 2^bits: at least floor((bits-1).log10(2)) + 1 digits,
+				// and one more for each further power of ten not above value. 10^digits
+				// stays below 2^(size_bits+4) so numwords + 1 words hold it
+				size_t digits = (bits - 1) * 301029 / 1000000 + 1;
 
-			std::string toHexString () const
-			{
-				const size_t bufferSize = sizeof(mathprim::u32) * numwords * 2;
+				mathprim::u32 power[numwords + 1];
+				kernels::zero(power, numwords + 1);
+				power[0] = 1;
 
-				char buffer[bufferSize + 1];
-				buffer[bufferSize] = 0;
+				for (size_t n = digits; n > 0; n -= std::min(n, size_t(9)))
+					kernels::mulAdd1(power, numwords + 1, n >= 9 ? 1000000000 : pow10(n), 0);
 
-				size_t index = bufferSize - 1;
-				for (size_t w = 0; w < numwords; w++)
+				while (power[numwords] == 0 && kernels::compare(value.m_words, power, numwords) >= 0)
 				{
-					mathprim::u32 word = m_words[w];
-
-					for (size_t n = 0; n < (sizeof(mathprim::u32) * 2); n++)
-					{
-						buffer[index] = "0123456789abcdef"[word & 0xf];
-						word = word >> 4;
-						index--;
-					}
+					digits++;
+					kernels::mulAdd1(power, numwords + 1, 10, 0);
 				}
 
-				return buffer;
+				return digits;
+			}
+
+			std::string toDecString () const
+			{
+				char buffer[maxCharsFor<10>() + 1];
+				char* end = buffer + sizeof(buffer);
+				return std::string(formatDecimal(end, false), end);
+			}
+
+			std::string toHexString () const
+			{
+				char buffer[numwords * 8];
+				kernels::hexEncode(buffer, m_words, numwords);
+				return std::string(buffer, buffer + sizeof(buffer));
 			}
 
 			int toInt () const
@@ -476,7 +718,6 @@ namespace bignum
 
 			static this_t fromDecString (const char* str)
 			{
-				this_t value = 0;
 				bool isneg = false;
 
 				if (*str == '-')
@@ -485,19 +726,10 @@ namespace bignum
 					str++;
 				}
 
-				while (*str)
-				{
-					if (isdigit(*str))
-					{
-						mulBy10(value, value);
-						value += *str - '0';
-						str++;
-					}
-					else
-					{
-						throw std::invalid_argument("Invalid Decimal Digit");
-					}
-				}
+				this_t value;
+				bool fits;
+				if (!parseDecimal(str, strlen(str), value, fits))
+					throw std::invalid_argument("Invalid Decimal Digit");
 
 				if (isneg)
 					twosComplement(value, value);
@@ -512,7 +744,6 @@ namespace bignum
 
 			static this_t fromHexString (const char* str)
 			{
-				this_t value = 0;
 				bool isneg = false;
 
 				if (*str == '-')
@@ -521,44 +752,380 @@ namespace bignum
 					str++;
 				}
 
-				if (_strnicmp (str, "0x", 2) == 0)
+				if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
 					str += 2;
 				else
 					throw std::invalid_argument("Invalid Hexadecimal Format");
 
-				while (*str)
+				this_t value;
+				bool fits;
+				if (!parseHex(str, strlen(str), value, fits))
+					throw std::invalid_argument("Invalid Hexadecimal Digit");
+
+				if (isneg)
+					twosComplement(value, value);
+
+				return value;
+			}
+
+			// value of the characters of an integer literal, decimal or 0x hex with '
+			// separators, for the _u128 / _u256 / _i256 literal operators. Hex may fill
+			// the sign bit of a signed type, decimal has to fit the positive range.
+			// Throws on anything else, which at compile time is a compile error
+			static constexpr this_t fromLiteral (const char* str, size_t length)
+			{
+				mathprim::u32 base = 10;
+				if (length > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+				{
+					base = 16;
+					str += 2;
+					length -= 2;
+				}
+				else if (length > 1 && str[0] == '0')
+				{
+					throw std::invalid_argument("Only Decimal And Hexadecimal Literals Are Supported");
+				}
+
+				this_t value;
+				for (; length > 0; length--, str++)
+				{
+					if (*str == '\'')
+						continue;
+
+					char c = char(*str | 0x20);
+					mathprim::u32 digit = (*str >= '0' && *str <= '9') ? *str - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : 16;
+					if (digit >= base)
+						throw std::invalid_argument("Invalid Literal Digit");
+
+					if (kernels::mulAdd1(value.m_words, numwords, base, digit))
+						throw std::out_of_range("Literal Out Of Range");
+				}
+
+				if (issigned && base == 10 && value.isNegative())
+					throw std::out_of_range("Literal Out Of Range");
+
+				return value;
+			}
+
+			// writes [-]digits in base 10 or 16 to [first, last) in the manner of std::to_chars:
+			// nothing is allocated or terminated and ptr is one past the last character.
+			// full_width pads the digits with leading zeros to the widest value of the type
+			std::to_chars_result toChars (char* first, char* last, int base = 10, digits_format format = digits_format::minimal) const
+			{
+				char buffer[maxCharsFor<10>() + 1];
+				char* end = buffer + sizeof(buffer);
+				char* start;
+
+				bool full = format == digits_format::full_width;
+				if (base == 10)
+					start = formatDecimal(end, full);
+				else if (base == 16)
+					start = formatHex(end, full);
+				else
+					return { last, std::errc::invalid_argument };
+
+				size_t length = end - start;
+				if (size_t(last - first) < length)
+					return { last, std::errc::value_too_large };
+
+				memcpy (first, start, length);
+				return { first + length, std::errc() };
+			}
+
+			// parses [-]digits in base 10 or 16 from [first, last) in the manner of std::from_chars:
+			// the longest run of digits is consumed, a sign only for signed types and no 0x
+			// prefix. Values outside the type give result_out_of_range
+			static std::from_chars_result fromChars (const char* first, const char* last, this_t& value, int base = 10)
+			{
+				const char* p = first;
+				bool neg = false;
+
+				if (issigned && p != last && *p == '-')
+				{
+					neg = true;
+					p++;
+				}
+
+				const char* digits = p;
+				if (base == 10)
+					while (p != last && *p >= '0' && *p <= '9')
+						p++;
+				else if (base == 16)
+					while (p != last && isxdigit((unsigned char)(*p)))
+						p++;
+				else
+					return { first, std::errc::invalid_argument };
+
+				if (p == digits)
+					return { first, std::errc::invalid_argument };
+
+				this_t magnitude;
+				bool fits;
+				if (base == 10)
+					parseDecimal(digits, p - digits, magnitude, fits);
+				else
+					parseHex(digits, p - digits, magnitude, fits);
+
+				// signed range is -2^(size_bits-1) .. 2^(size_bits-1) - 1
+				if (fits && issigned && magnitude.isNegative())
+					fits = neg && magnitude == (this_t(1) << (size_bits - 1));
+
+				if (!fits)
+					return { p, std::errc::result_out_of_range };
+
+				value = neg?-magnitude:magnitude;
+				return { p, std::errc() };
+			}
+
+			// value from up to size_bytes bytes in the given byte order, zero extended if
+			// fewer. Same order as the host is a straight copy, otherwise a byte swap per word
+			static this_t fromBytes (std::span<const std::byte> bytes, std::endian order)
+			{
+				if (bytes.size() > size_bytes)
+					throw std::invalid_argument("Too Many Bytes");
+
+				this_t value;
+				if (bytes.size() == size_bytes)
+				{
+					decodeBytes (bytes.data(), order, value);
+				}
+				else
+				{
+					std::byte padded[size_bytes] = {};
+					memcpy (order == std::endian::little ? padded : padded + size_bytes - bytes.size(), bytes.data(), bytes.size());
+					decodeBytes (padded, order, value);
+				}
+				return value;
+			}
+
+			// writes the size_bytes bytes of the value in the given byte order
+			void toBytes (std::span<std::byte> bytes, std::endian order) const
+			{
+				if (bytes.size() < size_bytes)
+					throw std::invalid_argument("Byte Buffer Too Small");
+
+				encodeBytes (*this, order, bytes.data());
+			}
+
+			// values.size() values from as many contiguous size_bytes records
+			static void fromBytes (std::span<const std::byte> bytes, std::endian order, std::span<this_t> values)
+			{
+				static_assert (sizeof(this_t) == size_bytes, "bigint arrays must be contiguous words");
+
+				if (bytes.size() != values.size() * size_bytes)
+					throw std::invalid_argument("Byte Count Does Not Match Value Count");
+
+				if (order == std::endian::little && std::endian::native == std::endian::little)
+					memcpy (values.data(), bytes.data(), bytes.size());
+				else
+					for (size_t i = 0; i < values.size(); i++)
+						decodeBytes (bytes.data() + i * size_bytes, order, values[i]);
+			}
+
+			// values as contiguous size_bytes records
+			static void toBytes (std::span<const this_t> values, std::span<std::byte> bytes, std::endian order)
+			{
+				if (bytes.size() < values.size() * size_bytes)
+					throw std::invalid_argument("Byte Buffer Too Small");
+
+				if (order == std::endian::little && std::endian::native == std::endian::little)
+					memcpy (bytes.data(), values.data(), values.size() * size_bytes);
+				else
+					for (size_t i = 0; i < values.size(); i++)
+						encodeBytes (values[i], order, bytes.data() + i * size_bytes);
+			}
+
+		private:
+			static mathprim::u32 pow10 (size_t n)
+			{
+				mathprim::u32 result = 1;
+				while (n--)
+					result *= 10;
+				return result;
+			}
+
+			// writes [-]decimal digits ending just before end, returns the first character.
+			// Digits come off in groups of nine, one single word division by 10^9 per
+			// group, and are written two at a time. end needs maxCharsFor<10>() before it
+			char* formatDecimal (char* end, bool fullWidth) const
+			{
+				char* pos = end;
+
+				bool neg = issigned && isNegative();
+				this_t value = neg?-*this:*this;
+
+				size_t n = kernels::significantWords(value.m_words, numwords);
+				if (n <= 2)
 				{
-					if (isxdigit(*str))
+					// under 2^64: the groups come off with native divides
+					mathprim::u64 v = value.low64();
+					for (; v >= 1000000000; v /= 1000000000)
+						pos = mathprim::writeDecimal(pos, mathprim::u32(v % 1000000000), 9);
+
+					pos = mathprim::writeDecimal(pos, mathprim::u32(v), mathprim::decimalDigits(mathprim::u32(v)));
+					n = 0;
+				}
+
+				while (n > 0)
+				{
+					mathprim::u32 group = kernels::divmod1Preinv(value.m_words, value.m_words, n, divc<1000000000>::normalized, divc<1000000000>::shift, divc<1000000000>::reciprocal);
+					n = kernels::significantWords(value.m_words, n);
+
+					pos = mathprim::writeDecimal(pos, group, n ? 9 : mathprim::decimalDigits(group));
+				}
+
+				if (fullWidth)
+					while (size_t(end - pos) < maxCharsFor<10>() - (issigned ? 1 : 0))
+						*--pos = '0';
+
+				if (neg) *--pos = '-';
+
+				return pos;
+			}
+
+			// as formatDecimal, in base 16
+			char* formatHex (char* end, bool fullWidth) const
+			{
+				bool neg = issigned && isNegative();
+				this_t value = neg?-*this:*this;
+
+				char* pos = end - numwords * 8;
+				kernels::hexEncode(pos, value.m_words, numwords);
+
+				if (!fullWidth)
+					while (pos < end - 1 && *pos == '0')
+						pos++;
+
+				if (neg) *--pos = '-';
+
+				return pos;
+			}
+
+			// value = the length decimal digits at str. fits is false if the value wrapped.
+			// Up to 19 digits are parsed as a native 64 bit value. Longer strings go eight
+			// digits at a time (SWAR), each group folded in with one multiply by 10^8 and
+			// add pass over the significant words. Returns false on a non digit
+			static bool parseDecimal (const char* str, size_t length, this_t& value, bool& fits)
+			{
+				value = 0;
+				fits = true;
+
+				if (length <= 19)
+				{
+					mathprim::u64 v = 0;
+					for (size_t n = 0; n < length; n++)
 					{
-						shiftLeft(value, 4, value);
-						value += mathprim::hexCharTou32 (*str);
-						str++;
+						if (!isdigit((unsigned char)(str[n])))
+							return false;
+						v = v * 10 + mathprim::u64(str[n] - '0');
 					}
+
+					value.m_words[0] = mathprim::u32(v);
+					if (numwords > 1)
+						value.m_words[1] = mathprim::u32(v >> 32);
 					else
-					{
-						throw std::invalid_argument("Invalid Hexadecimal Digit");
-					}
+						fits = (v >> 32) == 0;
+
+					return true;
 				}
 
-				if (isneg)
-					twosComplement(value, value);
+				// leading length % 8 digits, then whole groups
+				mathprim::u32 head = 0;
+				for (size_t n = length % 8; n > 0; n--, str++)
+				{
+					if (!isdigit((unsigned char)(*str)))
+						return false;
+					head = head * 10 + mathprim::u32(*str - '0');
+				}
 
-				return value;
+				value.m_words[0] = head;
+				size_t size = head ? 1 : 0;
+
+				for (size_t n = length / 8; n > 0; n--, str += 8)
+				{
+					mathprim::u32 group;
+					if (!mathprim::parseEightDigits(str, group))
+						return false;
+
+					mathprim::u32 carry = kernels::mulAdd1(value.m_words, size, 100000000, group);
+					if (carry && size < numwords)
+						value.m_words[size++] = carry;
+					else if (carry)
+						fits = false;
+				}
+
+				return true;
+			}
+
+			// word i sits at byte 4i (little endian) or size_bytes - 4(i + 1) (big endian)
+			static void decodeBytes (const std::byte* bytes, std::endian order, this_t& value)
+			{
+				if (order == std::endian::little && std::endian::native == std::endian::little)
+				{
+					memcpy (value.m_words, bytes, size_bytes);
+					return;
+				}
+
+				for (size_t i = 0; i < numwords; i++)
+				{
+					mathprim::u32 word;
+					memcpy (&word, bytes + (order == std::endian::little ? 4 * i : size_bytes - 4 * (i + 1)), 4);
+					value.m_words[i] = order == std::endian::native ? word : mathprim::byteSwap32(word);
+				}
 			}
 
+			static void encodeBytes (const this_t& value, std::endian order, std::byte* bytes)
+			{
+				if (order == std::endian::little && std::endian::native == std::endian::little)
+				{
+					memcpy (bytes, value.m_words, size_bytes);
+					return;
+				}
+
+				for (size_t i = 0; i < numwords; i++)
+				{
+					mathprim::u32 word = order == std::endian::native ? value.m_words[i] : mathprim::byteSwap32(value.m_words[i]);
+					memcpy (bytes + (order == std::endian::little ? 4 * i : size_bytes - 4 * (i + 1)), &word, 4);
+				}
+			}
+
+			// value = the length hex digits at str, as parseDecimal
+			static bool parseHex (const char* str, size_t length, this_t& value, bool& fits)
+			{
+				value = 0;
+
+				for (; length > 0 && *str == '0'; length--)
+					str++;
+
+				// digits above the top word only need checking
+				fits = length <= numwords * 8;
+				for (; length > numwords * 8; length--, str++)
+					if (!isxdigit((unsigned char)(*str)))
+						return false;
+
+				size_t words = length / 8;
+				size_t head = length % 8;
+
+				if (head && !kernels::hexDecodeWord(str, head, value.m_words[words]))
+					return false;
+
+				return kernels::hexDecode(value.m_words, str + head, words);
+			}
+
+		public:
 
 	// ==============================================================
 	//      bit manipulation
 	// ==============================================================
 
-			inline bool getBit (size_t index) const 
+			constexpr bool getBit (size_t index) const 
 			{
 				size_t wordIndex = index / 32;
 				size_t bitIndex = index - wordIndex * 32;
 				return (m_words[wordIndex] & (0x1 << bitIndex)) != 0;
 			}
 
-			inline void setBit (size_t index, bool value)
+			constexpr void setBit (size_t index, bool value)
 			{
 				size_t wordIndex = index / 32;
 				size_t bitIndex = index - wordIndex * 32;
@@ -574,28 +1141,28 @@ namespace bignum
 	//      Arithmetic operators
 	// ==============================================================
 
-			inline this_t operator+(const this_t& value) const
+			constexpr this_t operator+(const this_t& value) const
 			{
 				this_t result;
 				add (*this, value, result);
 				return result;
 			}
 
-			inline this_t operator-(const this_t& value) const
+			constexpr this_t operator-(const this_t& value) const
 			{
 				this_t result;
 				sub (*this, value, result);
 				return result;
 			}
 
-			inline this_t operator-() const
+			constexpr this_t operator-() const
 			{
 				this_t result;
 				twosComplement(*this, result);
 				return result;
 			}
 
-			inline this_t operator*(const this_t& value) const
+			constexpr this_t operator*(const this_t& value) const
 			{
 				this_t result;
 				if (issigned)
@@ -606,7 +1173,7 @@ namespace bignum
 				return result;
 			}
 
-			inline this_t operator/(const this_t& value) const
+			constexpr this_t operator/(const this_t& value) const
 			{
 				this_t quotient;
 				this_t modulo;
@@ -618,19 +1185,19 @@ namespace bignum
 				return quotient;
 			}
 
-			inline this_t& operator+=(const this_t& value)
+			constexpr this_t& operator+=(const this_t& value)
 			{
 				add (*this, value, *this);
 				return *this;
 			}
 
-			inline this_t& operator-=(const this_t& value)
+			constexpr this_t& operator-=(const this_t& value)
 			{
 				sub (*this, value, *this);
 				return *this;
 			}
 
-			inline this_t& operator*=(const this_t& value)
+			constexpr this_t& operator*=(const this_t& value)
 			{
 				if (issigned)
 					smul (*this, value, *this);
@@ -640,7 +1207,7 @@ namespace bignum
 				return *this;
 			}
 
-			inline this_t& operator/=(const this_t& value)
+			constexpr this_t& operator/=(const this_t& value)
 			{
 				this_t modulo;
 				if (issigned)
@@ -651,33 +1218,33 @@ namespace bignum
 				return *this;
 			}
 
-			inline this_t& operator++ ()    // prefix ++x
+			constexpr this_t& operator++ ()    // prefix ++x
 			{
 				add (*this, 1, *this);
 				return *this;
 			}
 
-			inline this_t  operator++ (int) // postfix x++
+			constexpr this_t  operator++ (int) // postfix x++
 			{
 				this_t temp = *this;
 				add (*this, 1, *this);
 				return temp;
 			}
 
-			inline this_t& operator-- ()    // prefix --x
+			constexpr this_t& operator-- ()    // prefix --x
 			{
 				sub (*this, 1, *this);
 				return *this;
 			}
 
-			inline this_t  operator-- (int) // postfix x--
+			constexpr this_t  operator-- (int) // postfix x--
 			{
 				this_t temp = *this;
 				sub (*this, 1, *this);
 				return temp;
 			}
 
-			inline this_t operator% (const this_t& value) const
+			constexpr this_t operator% (const this_t& value) const
 			{
 				this_t quotient;
 				this_t modulo;
@@ -689,7 +1256,7 @@ namespace bignum
 				return modulo;
 			}
 
-			inline this_t& operator%= (const this_t& value)
+			constexpr this_t& operator%= (const this_t& value)
 			{
 				this_t quotient;
 				if (issigned)
@@ -699,13 +1266,39 @@ namespace bignum
 
 				return *this;
 			}
+
+			// true if value divides this with no remainder, the quotient is never formed
+			constexpr bool isDivisibleBy (const this_t& value) const
+			{
+				if (value == 0) 
+					throw std::invalid_argument("Divide By Zero");
+
+				this_t a = (issigned && isNegative())?-*this:*this;
+				this_t d = (issigned && value.isNegative())?-value:value;
+
+				size_t zeros = kernels::trailingZeroBits(d.m_words, numwords);
+				if (kernels::trailingZeroBits(a.m_words, numwords) < zeros)
+					return false;
+
+				shiftRightUnsigned(a, zeros, a);
+				shiftRightUnsigned(d, zeros, d);
+
+				size_t n = kernels::significantWords(a.m_words, numwords);
+				size_t m = kernels::significantWords(d.m_words, numwords);
+
+				if (n < m)
+					return n == 0;
+
+				mathprim::u32 scratch[2 * numwords];
+				return kernels::divisibleOdd(a.m_words, n, d.m_words, m, scratch);
+			}
 	        
 
 	// ==============================================================
 	//      logical operators
 	// ==============================================================
 
-			inline this_t operator>>(size_t shift) const
+			constexpr this_t operator>>(size_t shift) const
 			{
 				this_t result;
 				if (issigned)
@@ -716,14 +1309,14 @@ namespace bignum
 				return result;
 			}
 
-			inline this_t  operator<<(size_t shift) const
+			constexpr this_t  operator<<(size_t shift) const
 			{
 				this_t result;
 				shiftLeft(*this, shift, result);
 				return result;
 			}
 
-			inline this_t& operator>>=(size_t shift)
+			constexpr this_t& operator>>=(size_t shift)
 			{
 				if (issigned)
 					shiftRightSigned(*this, shift, *this);
@@ -733,52 +1326,52 @@ namespace bignum
 				return *this;
 			}
 
-			inline this_t& operator<<=(size_t shift)
+			constexpr this_t& operator<<=(size_t shift)
 			{
 				shiftLeft(*this, shift, *this);
 				return *this;
 			}
 
-			inline this_t  operator^(const this_t& value) const
+			constexpr this_t  operator^(const this_t& value) const
 			{
 				this_t result;
 				xor (*this, value, result);
 				return result;
 			}
 
-			inline this_t  operator|(const this_t& value) const
+			constexpr this_t  operator|(const this_t& value) const
 			{
 				this_t result;
 				or (*this, value, result);
 				return result;
 			}
 
-			inline this_t  operator&(const this_t& value) const
+			constexpr this_t  operator&(const this_t& value) const
 			{
 				this_t result;
 				and (*this, value, result);
 				return result;
 			}
 
-			inline this_t& operator^=(const this_t& value)
+			constexpr this_t& operator^=(const this_t& value)
 			{
 				xor (*this, value, *this);
 				return *this;
 			}
 
-			inline this_t& operator|=(const this_t& value)
+			constexpr this_t& operator|=(const this_t& value)
 			{
 				or (*this, value, *this);
 				return *this;
 			}
 
-			inline this_t& operator&=(const this_t& value)
+			constexpr this_t& operator&=(const this_t& value)
 			{
 				and (*this, value, *this);
 				return *this;
 			}
 
-			this_t operator ~() const
+			constexpr this_t operator ~() const
 			{
 				this_t result;
 				onesCompliment(*this, result);
@@ -794,12 +1387,12 @@ namespace bignum
 	//      comparison operators
 	// ==============================================================
 
-			inline bool operator == (const this_t& value) const
+			constexpr bool operator == (const this_t& value) const
 			{
 				return unsignedCompare(*this, value) == 0;
 			}
 
-			inline bool operator >  (const this_t& value) const
+			constexpr bool operator >  (const this_t& value) const
 			{
 				int result;
 				if (issigned)
@@ -810,7 +1403,7 @@ namespace bignum
 				return result > 0;
 			}
 
-			inline bool operator <  (const this_t& value) const
+			constexpr bool operator <  (const this_t& value) const
 			{
 				int result;
 				if (issigned)
@@ -821,7 +1414,7 @@ namespace bignum
 				return result < 0;
 			}
 
-			inline bool operator >= (const this_t& value) const
+			constexpr bool operator >= (const this_t& value) const
 			{
 				int result;
 				if (issigned)
@@ -832,7 +1425,7 @@ namespace bignum
 				return result > 0 || result == 0;
 			}
 
-			inline bool operator <= (const this_t& value) const
+			constexpr bool operator <= (const this_t& value) const
 			{
 				int result;
 				if (issigned)
@@ -843,17 +1436,17 @@ namespace bignum
 				return result < 0 || result == 0;
 			}
 
-			inline bool operator != (const this_t& value) const
+			constexpr bool operator != (const this_t& value) const
 			{
 				return unsignedCompare(*this, value) != 0;
 			}
 
-			inline bool isNegative () const
+			constexpr bool isNegative () const
 			{
 				return (m_words[numwords - 1] & mathprim::MSB_mask) != 0;
 			}
 
-			inline bool isZero () const
+			constexpr bool isZero () const
 			{
 				for (int n = 0; n < numwords; n++)
 					if (m_words[n])
@@ -866,7 +1459,7 @@ namespace bignum
 	//      Misc
 	// ==============================================================
 
-			inline this_t maxValue () const
+			constexpr this_t maxValue () const
 			{
 				this_t res;
 				for (int n = 0; n < numwords - 1; n++)
@@ -877,10 +1470,10 @@ namespace bignum
 				return res;
 			}
 
-			inline this_t minValue () const
+			constexpr this_t minValue () const
 			{
 				this_t res;
-				if (signed)
+				if (!issigned)
 				{
 					for (int n = 0; n < numwords; n++)
 						res.m_words[n] = 0;
@@ -896,18 +1489,18 @@ namespace bignum
 				return res;
 			}
 
-			mathprim::u32 getWord (size_t wordIndex) const
+			constexpr mathprim::u32 getWord (size_t wordIndex) const
 			{
 				return m_words[wordIndex];
 			}
 
-			void setWord (size_t wordIndex, mathprim::u32 value)
+			constexpr void setWord (size_t wordIndex, mathprim::u32 value)
 			{
 				m_words[wordIndex] = value;
 			}
 
 			// returns the index of the most significant bit set - or 0xffffffff if no bits set 
-			size_t indexMSB () const 
+			constexpr size_t indexMSB () const 
 			{
 				size_t index = size_bits;
 
@@ -923,6 +1516,198 @@ namespace bignum
 
 				return -1;
 			}
+
+	// ==============================================================
+	//      Division by invariant divisors
+	// ==============================================================
+
+			// Divides by a value fixed at construction using multiplications only.
+			// Single word divisors use a precomputed word reciprocal. Wider ones use
+			// x ~ 2^(size_bits + 3) / d, found by Newton-Raphson from a double estimate
+			// to only the bits a quotient can have, so that the quotient estimate
+			// (a * x / B^numwords) >> 3 is a short product. Every rounding is down and
+			// the estimate is at most 2 below the true quotient.
+			// Signed values follow operator/ and operator%.
+			class divider
+			{
+				public:
+					constexpr divider (const this_t& divisor)
+					{
+						if (divisor == 0) 
+							throw std::invalid_argument("Divide By Zero");
+
+						m_negative = issigned && divisor.isNegative();
+						m_divisor = m_negative?-divisor:divisor;
+						m_size = kernels::significantWords(m_divisor.m_words, numwords);
+
+						if (m_size == 1)
+						{
+							m_shift = mathprim::numLeadingZeros(m_divisor.m_words[0]);
+							m_reciprocal = mathprim::reciprocalWord(m_divisor.m_words[0] << m_shift);
+						}
+						else
+						{
+							invert();
+						}
+					}
+
+					constexpr void divmod (const this_t& a, this_t& quotient, this_t& modulo) const
+					{
+						bool aneg = issigned && a.isNegative();
+
+						this_t value = aneg?-a:a;
+						this_t q(0);
+						this_t r(0);
+
+						if (m_size == 1)
+							r.m_words[0] = kernels::divmod1Preinv(q.m_words, value.m_words, numwords, m_divisor.m_words[0] << m_shift, m_shift, m_reciprocal);
+						else if (std::is_constant_evaluated())
+							divmodInverse(q.m_words, r.m_words, value.m_words, m_inverse.m_words, m_divisor.m_words, numwords);
+						else
+							divmodInverse(q.m_limbs, r.m_limbs, value.m_limbs, m_inverse.m_limbs, m_divisor.m_limbs, size_limbs);
+
+						if (aneg != m_negative)
+							this_t::twosComplement(q, q);
+
+						quotient = q;
+						modulo = r;
+					}
+
+					constexpr this_t div (const this_t& a) const
+					{
+						this_t quotient;
+						this_t modulo;
+						divmod (a, quotient, modulo);
+						return quotient;
+					}
+
+					constexpr this_t mod (const this_t& a) const
+					{
+						this_t quotient;
+						this_t modulo;
+						divmod (a, quotient, modulo);
+						return modulo;
+					}
+
+				private:
+					// quotients are under 2^(size_bits - bits + 1) for a bits wide divisor and x 
+					// carries 3 more. With y the divisor normalised to [1/2, 1), x ~ 1/y with 
+					// precision - 1 fraction bits, and each step x += x(1 - yx) doubles the 
+					// correct bits. The estimate starts below 1/y and Newton-Raphson stays 
+					// below when rounded down
+					constexpr void invert ()
+					{
+						size_t bits = m_divisor.indexMSB() + 1;
+						size_t precision = size_bits + 4 - bits;
+
+						this_t y;
+						shiftLeft(m_divisor, size_bits - bits, y);
+
+						// 44 bits from the top 64 of y, pulled down by 2^-45
+						mathprim::u64 top = (mathprim::u64(y.m_words[numwords - 1]) << 32) | y.m_words[numwords - 2];
+						double estimate = 18446744073709551616.0 / (double(top) + 1.0) * (1.0 - 1.0 / 35184372088832.0);
+
+						size_t bitsDone = 44;
+						this_t x((unsigned __int64)(estimate * 8796093022208.0));
+
+						while (bitsDone < precision)
+						{
+							size_t next = std::min(2 * bitsDone - 4, precision);
+							shiftLeft(x, next - bitsDone, x);
+
+							// e = 1 - yx to next bits
+							wide_t product;
+							umulFull(y, x, product);
+							wide_t error = (wide_t(1) << (size_bits + next - 1)) - product;
+							wide_t::shiftRightUnsigned(error, size_bits - 1, error);
+
+							umulFull(x, error.template cast<this_t>(), product);
+							wide_t::shiftRightUnsigned(product, next, product);
+							add(x, product.template cast<this_t>(), x);
+
+							bitsDone = next;
+						}
+
+						shiftRightUnsigned(x, bitsDone - precision, m_inverse);
+					}
+
+					// q = a / d and r = a % d for unsigned a over n words or limbs. a * x / B^n
+					// is formed from its top columns, then the remainder, under 3d, from the
+					// words of d and one more
+					template <typename word_t>
+					static constexpr void divmodInverse (word_t* q, word_t* r, const word_t* a, const word_t* x, const word_t* d, size_t n)
+					{
+						size_t na = kernels::significantWords(a, n);
+						size_t nx = kernels::significantWords(x, n);
+						size_t nd = kernels::significantWords(d, n);
+
+						word_t high[numwords];
+						size_t nq = na + nx > n ? na + nx - n : 0;
+						kernels::mulHighBasecase(high, a, na, x, nx, n);
+						if (nq)
+							kernels::shiftRightBits(q, high, nq, 3);
+
+						size_t nr = std::min(nd + 1, n);
+						word_t product[numwords];
+						kernels::mulLowBasecase(product, q, kernels::significantWords(q, nq), d, nd, nr);
+						kernels::sub(r, a, product, nr);
+
+						while (kernels::compare(r, d, nr) >= 0)
+						{
+							kernels::sub(r, r, d, nr);
+							for (size_t i = 0; i < n && ++q[i] == 0; i++) 
+								;
+						}
+					}
+
+					this_t m_divisor;
+					bool m_negative = false;
+					size_t m_size = 0;
+
+					// single word divisor
+					size_t m_shift = 0;
+					mathprim::u32 m_reciprocal = 0;
+
+					// wider divisors, x
+					this_t m_inverse;
+			};
+
+			// Divides by the compile time constant d with its reciprocal folded in at
+			// compile time, e.g. uint256::divc<10>::div(value, quotient). Signed values
+			// follow operator/ and operator%.
+			template <mathprim::u32 d>
+			class divc
+			{
+				public:
+					static const size_t shift = mathprim::leadingZeros(d);
+					static const mathprim::u32 normalized = d << shift;
+					static const mathprim::u32 reciprocal = mathprim::reciprocalWord(normalized);
+
+					// quotient = a / d, returns a % d
+					constexpr static mathprim::u32 divmod (const this_t& a, this_t& quotient)
+					{
+						bool neg = issigned && a.isNegative();
+						this_t value = neg?-a:a;
+
+						mathprim::u32 r = kernels::divmod1Preinv(quotient.m_words, value.m_words, numwords, normalized, shift, reciprocal);
+
+						if (neg)
+							this_t::twosComplement(quotient, quotient);
+
+						return r;
+					}
+
+					constexpr static void div (const this_t& a, this_t& quotient)
+					{
+						divmod (a, quotient);
+					}
+
+					constexpr static mathprim::u32 mod (const this_t& a)
+					{
+						this_t quotient;
+						return divmod (a, quotient);
+					}
+			};
 	};
 
 	template <typename numericType>
@@ -934,11 +1719,40 @@ namespace bignum
 			return val;
 	}
 
+	// std::to_chars / std::from_chars style conversions, see bigint::toChars / fromChars
+	template <size_t numwords, bool issigned, typename limb_t>
+	std::to_chars_result to_chars (char* first, char* last, const bigint<numwords, issigned, limb_t>& value, int base = 10, digits_format format = digits_format::minimal)
+	{
+		return value.toChars(first, last, base, format);
+	}
+
+	template <size_t numwords, bool issigned, typename limb_t>
+	std::from_chars_result from_chars (const char* first, const char* last, bigint<numwords, issigned, limb_t>& value, int base = 10)
+	{
+		return bigint<numwords, issigned, limb_t>::fromChars(first, last, value, base);
+	}
+
 	typedef bigint<4, true>   int128;
 	typedef bigint<4, false> uint128;
 	typedef bigint<8, true>   int256;
 	typedef bigint<8, false> uint256;
 
+	// compile time constants, e.g. using namespace bignum::literals; 0xffff..._u256
+	namespace literals
+	{
+		template <typename bigint_t, char... chars>
+		consteval bigint_t parseLiteral ()
+		{
+			const char str[] = { chars... };
+			return bigint_t::fromLiteral(str, sizeof...(chars));
+		}
+
+		template <char... chars> consteval int128  operator""_i128 () { return parseLiteral<int128, chars...>(); }
+		template <char... chars> consteval uint128 operator""_u128 () { return parseLiteral<uint128, chars...>(); }
+		template <char... chars> consteval int256  operator""_i256 () { return parseLiteral<int256, chars...>(); }
+		template <char... chars> consteval uint256 operator""_u256 () { return parseLiteral<uint256, chars...>(); }
+	}
+
 }
 
 
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "bigint.h"
+#include "kernels.h"
+#include "montgomery.h"
+
+namespace bignum
+{
+	// ==============================================================
+	//      Batches of bigints
+	// ==============================================================
+	//
+	// N unsigned bigints stored structure of arrays: word w of every element
+	// is contiguous, so one vector instruction handles the same word of
+	// several elements. Operations are element wise and wrap like the bigint
+	// operators; results may alias the inputs. With AVX2 four elements go
+	// through each vector, every 32 bit word zero extended into a 64 bit lane
+	// so that _mm256_mul_epu32 products and the carries fit. Without AVX2, and
+	// for the last N % 4 elements, one element at a time.
+
+	template <size_t N, size_t numwords>
+	class bigint_batch
+	{
+		public:
+			typedef bigint_batch<N, numwords> this_t;
+			typedef bigint<numwords, false> bigint_t;
+			typedef montgomery_context<bigint_t> montgomery_t;
+			static const size_t size = N;
+			static const size_t size_words = numwords;
+
+			bigint_batch ()
+			{
+				for (size_t w = 0; w < numwords; w++)
+					for (size_t i = 0; i < N; i++)
+						m_words[w][i] = 0;
+			}
+
+			// transpose in from N bigints
+			void load (const bigint_t* values)
+			{
+				for (size_t i = 0; i < N; i++)
+					set (i, values[i]);
+			}
+
+			// transpose out to N bigints
+			void store (bigint_t* values) const
+			{
+				for (size_t i = 0; i < N; i++)
+					values[i] = get (i);
+			}
+
+			bigint_t get (size_t index) const
+			{
+				bigint_t result;
+				for (size_t w = 0; w < numwords; w++)
+					result.setWord(w, m_words[w][index]);
+				return result;
+			}
+
+			void set (size_t index, const bigint_t& value)
+			{
+				for (size_t w = 0; w < numwords; w++)
+					m_words[w][index] = value.getWord(w);
+			}
+
+			// result[i] = a[i] + b[i]
+			static void add (const this_t& a, const this_t& b, this_t& result)
+			{
+				size_t i = 0;
+#ifdef BIGNUM_X86_KERNELS
+				if (cpu::getFeatures().avx2)
+					for (; i + 4 <= N; i += 4)
+						add4 (a, b, result, i);
+#endif
+				for (; i < N; i++)
+					result.set (i, a.get(i) + b.get(i));
+			}
+
+			// result[i] = a[i] - b[i]
+			static void sub (const this_t& a, const this_t& b, this_t& result)
+			{
+				size_t i = 0;
+#ifdef BIGNUM_X86_KERNELS
+				if (cpu::getFeatures().avx2)
+					for (; i + 4 <= N; i += 4)
+						sub4 (a, b, &result, i, 0);
+#endif
+				for (; i < N; i++)
+					result.set (i, a.get(i) - b.get(i));
+			}
+
+			// result[i] = < 0 if a[i] < b[i];  0 if a[i] == b[i]; > 0 if a[i] > b[i]
+			static void compare (const this_t& a, const this_t& b, int* result)
+			{
+				size_t i = 0;
+#ifdef BIGNUM_X86_KERNELS
+				if (cpu::getFeatures().avx2)
+					for (; i + 4 <= N; i += 4)
+						sub4 (a, b, 0, i, result + i);
+#endif
+				for (; i < N; i++)
+					result[i] = bigint_t::unsignedCompare(a.get(i), b.get(i));
+			}
+
+			// result[i] = low numwords of a[i] * b[i]
+			static void mul (const this_t& a, const this_t& b, this_t& result)
+			{
+				size_t i = 0;
+#ifdef BIGNUM_X86_KERNELS
+				if (cpu::getFeatures().avx2)
+					for (; i + 4 <= N; i += 4)
+						mul4 (a, b, result, i);
+#endif
+				for (; i < N; i++)
+					result.set (i, a.get(i) * b.get(i));
+			}
+
+			// result[i] = a[i] * b[i] * R^-1 mod m, operands in Montgomery form and less than m
+			static void montgomeryMul (const this_t& a, const this_t& b, const montgomery_t& ctx, this_t& result)
+			{
+				size_t i = 0;
+#ifdef BIGNUM_X86_KERNELS
+				if (cpu::getFeatures().avx2)
+					for (; i + 4 <= N; i += 4)
+						montgomeryMul4 (a, b, ctx, result, i);
+#endif
+				for (; i < N; i++)
+					result.set (i, ctx.mulmod(a.get(i), b.get(i)));
+			}
+
+		private:
+			// m_words[w][i] = word w of element i
+			mathprim::u32 m_words[numwords][N];
+
+#ifdef BIGNUM_X86_KERNELS
+			// ==============================================================
+			//      AVX2 kernels, elements [i, i + 4)
+			// ==============================================================
+
+			// 4 words -> low halves of 4 64 bit lanes
+			BIGNUM_TARGET_AVX2
+			static __m256i load4 (const mathprim::u32* p)
+			{
+				return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(p)));
+			}
+
+			// low halves of 4 64 bit lanes -> 4 words
+			BIGNUM_TARGET_AVX2
+			static void store4 (mathprim::u32* p, __m256i v)
+			{
+				__m256i even = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+				_mm_storeu_si128((__m128i*)(p), _mm256_castsi256_si128(even));
+			}
+
+			BIGNUM_TARGET_AVX2
+			static void add4 (const this_t& a, const this_t& b, this_t& result, size_t i)
+			{
+				__m256i carry = _mm256_setzero_si256();
+
+				for (size_t w = 0; w < numwords; w++)
+				{
+					__m256i s = _mm256_add_epi64(_mm256_add_epi64(load4(&a.m_words[w][i]), load4(&b.m_words[w][i])), carry);
+					store4 (&result.m_words[w][i], s);
+					carry = _mm256_srli_epi64(s, 32);
+				}
+			}
+
+			// result = a - b when result is given, otherwise the sign of a - b into cmp
+			BIGNUM_TARGET_AVX2
+			static void sub4 (const this_t& a, const this_t& b, this_t* result, size_t i, int* cmp)
+			{
+				const __m256i mask = _mm256_set1_epi64x(0xffffffff);
+				__m256i borrow = _mm256_setzero_si256();
+				__m256i nonzero = _mm256_setzero_si256();
+
+				for (size_t w = 0; w < numwords; w++)
+				{
+					__m256i d = _mm256_sub_epi64(_mm256_sub_epi64(load4(&a.m_words[w][i]), load4(&b.m_words[w][i])), borrow);
+					if (result)
+						store4 (&result->m_words[w][i], d);
+					nonzero = _mm256_or_si256(nonzero, _mm256_and_si256(d, mask));
+					borrow = _mm256_srli_epi64(d, 63);
+				}
+
+				if (cmp)
+				{
+					alignas(32) mathprim::u64 borrows[4];
+					alignas(32) mathprim::u64 nonzeros[4];
+					_mm256_store_si256((__m256i*)(borrows), borrow);
+					_mm256_store_si256((__m256i*)(nonzeros), nonzero);
+
+					for (size_t n = 0; n < 4; n++)
+						cmp[n] = borrows[n] ? -1 : (nonzeros[n] ? 1 : 0);
+				}
+			}
+
+			// product scanning over the low numwords columns. Each column sums the
+			// low and high halves of its products separately so nothing overflows
+			BIGNUM_TARGET_AVX2
+			static void mul4 (const this_t& a, const this_t& b, this_t& result, size_t i)
+			{
+				const __m256i mask = _mm256_set1_epi64x(0xffffffff);
+
+				__m256i av[numwords];
+				__m256i bv[numwords];
+				for (size_t w = 0; w < numwords; w++)
+				{
+					av[w] = load4(&a.m_words[w][i]);
+					bv[w] = load4(&b.m_words[w][i]);
+				}
+
+				__m256i carry = _mm256_setzero_si256();
+				for (size_t k = 0; k < numwords; k++)
+				{
+					__m256i lo = carry;
+					__m256i hi = _mm256_setzero_si256();
+
+					for (size_t j = 0; j <= k; j++)
+					{
+						__m256i p = _mm256_mul_epu32(av[j], bv[k - j]);
+						lo = _mm256_add_epi64(lo, _mm256_and_si256(p, mask));
+						hi = _mm256_add_epi64(hi, _mm256_srli_epi64(p, 32));
+					}
+
+					store4 (&result.m_words[k][i], lo);
+					carry = _mm256_add_epi64(_mm256_srli_epi64(lo, 32), hi);
+				}
+			}
+
+			// CIOS as kernels::montgomeryMul, one element per lane
+			BIGNUM_TARGET_AVX2
+			static void montgomeryMul4 (const this_t& a, const this_t& b, const montgomery_t& ctx, this_t& result, size_t i)
+			{
+				const __m256i mask = _mm256_set1_epi64x(0xffffffff);
+				const __m256i minv = _mm256_set1_epi64x(ctx.minv());
+
+				__m256i av[numwords];
+				__m256i bv[numwords];
+				__m256i mv[numwords];
+				__m256i t[numwords + 2];
+
+				for (size_t w = 0; w < numwords; w++)
+				{
+					av[w] = load4(&a.m_words[w][i]);
+					bv[w] = load4(&b.m_words[w][i]);
+					mv[w] = _mm256_set1_epi64x(ctx.modulus().getWord(w));
+				}
+
+				for (size_t w = 0; w < numwords + 2; w++)
+					t[w] = _mm256_setzero_si256();
+
+				for (size_t n = 0; n < numwords; n++)
+				{
+					// t += a * b[n]
+					__m256i c = _mm256_setzero_si256();
+					for (size_t j = 0; j < numwords; j++)
+					{
+						__m256i p = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(av[j], bv[n]), t[j]), c);
+						t[j] = _mm256_and_si256(p, mask);
+						c = _mm256_srli_epi64(p, 32);
+					}
+					__m256i p = _mm256_add_epi64(t[numwords], c);
+					t[numwords] = _mm256_and_si256(p, mask);
+					t[numwords + 1] = _mm256_srli_epi64(p, 32);
+
+					// t = (t + q.m) / 2^32 with q chosen to clear the low word
+					__m256i q = _mm256_and_si256(_mm256_mul_epu32(t[0], minv), mask);
+					c = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epu32(q, mv[0]), t[0]), 32);
+					for (size_t j = 1; j < numwords; j++)
+					{
+						p = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(q, mv[j]), t[j]), c);
+						t[j - 1] = _mm256_and_si256(p, mask);
+						c = _mm256_srli_epi64(p, 32);
+					}
+					p = _mm256_add_epi64(t[numwords], c);
+					t[numwords - 1] = _mm256_and_si256(p, mask);
+					t[numwords] = _mm256_add_epi64(t[numwords + 1], _mm256_srli_epi64(p, 32));
+				}
+
+				// t < 2m: subtract m unless that borrows out of t
+				__m256i u[numwords];
+				__m256i borrow = _mm256_setzero_si256();
+				for (size_t w = 0; w < numwords; w++)
+				{
+					__m256i d = _mm256_sub_epi64(_mm256_sub_epi64(t[w], mv[w]), borrow);
+					u[w] = d;
+					borrow = _mm256_srli_epi64(d, 63);
+				}
+
+				__m256i keep = _mm256_cmpgt_epi64(borrow, t[numwords]);
+				for (size_t w = 0; w < numwords; w++)
+					store4 (&result.m_words[w][i], _mm256_blendv_epi8(u[w], t[w], keep));
+			}
+#endif
+	};
+}
@@ -0,0 +1,611 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "bigint.h"
+#include "kernels.h"
+#include "montgomery.h"
+
+namespace bignum
+{
+	// ==============================================================
+	//      Exponentiation
+	// ==============================================================
+
+	// exponent bit length -> sliding window size, trading table setup
+	// (2^(k-1) multiplies) against the multiplies saved in the scan
+	inline size_t powWindowSize (size_t bits)
+	{
+		if (bits <= 8)   return 1;
+		if (bits <= 24)  return 2;
+		if (bits <= 80)  return 3;
+		if (bits <= 240) return 4;
+		if (bits <= 672) return 5;
+		return 6;
+	}
+
+	// plain wrapping arithmetic, for pow
+	template <typename bigint_t>
+	class wrapping_context
+	{
+		public:
+			bigint_t one () const                                       { return bigint_t(1); }
+			bigint_t mulmod (const bigint_t& a, const bigint_t& b) const { return a * b; }
+			bigint_t sqrmod (const bigint_t& a) const                    { return a * a; }
+	};
+
+	// a * b mod m via the double width product and a division, for even moduli
+	template <typename bigint_t>
+	class division_context
+	{
+		public:
+			static const size_t numwords = bigint_t::size_words;
+
+			division_context (const bigint_t& modulus) : m_modulus(modulus)
+			{
+				if (modulus == 0)
+					throw std::invalid_argument("Divide By Zero");
+
+				m_size = kernels::significantWords(&m_modulus.m_words[0], numwords);
+			}
+
+			bigint_t one () const
+			{
+				return m_size == 1 && m_modulus == 1 ? bigint_t(0) : bigint_t(1);
+			}
+
+			bigint_t mulmod (const bigint_t& a, const bigint_t& b) const
+			{
+				mathprim::u32 product[2 * numwords];
+				kernels::mulBasecase(product, &a.m_words[0], &b.m_words[0], numwords);
+				return reduce (product);
+			}
+
+			bigint_t sqrmod (const bigint_t& a) const
+			{
+				mathprim::u32 product[2 * numwords];
+				kernels::sqrBasecase(product, &a.m_words[0], numwords);
+				return reduce (product);
+			}
+
+		private:
+			bigint_t reduce (const mathprim::u32* product) const
+			{
+				mathprim::u32 quotient[2 * numwords];
+				mathprim::u32 scratch[3 * numwords + 1];
+
+				bigint_t result (0);
+				size_t n = kernels::significantWords(product, 2 * numwords);
+
+				if (n < m_size)
+					kernels::copy(&result.m_words[0], product, n);
+				else if (m_size == 1)
+					result.m_words[0] = kernels::divmod1(quotient, product, n, m_modulus.m_words[0]);
+				else
+					kernels::divmod(quotient, &result.m_words[0], product, n, &m_modulus.m_words[0], m_size, scratch);
+
+				return result;
+			}
+
+			bigint_t m_modulus;
+			size_t m_size;
+	};
+
+	// base^exp in the arithmetic of context_t, base already in the context's form.
+	// Left to right sliding window: the odd powers base^1, base^3 .. base^(2^k - 1)
+	// are tabled, then each window of up to k exponent bits that starts and ends
+	// with a 1 costs one table multiply, with squarings in between.
+	template <typename context_t, typename bigint_t>
+	bigint_t slidingWindowPow (const context_t& ctx, const bigint_t& base, const bigint_t& exp)
+	{
+		size_t top = exp.indexMSB();
+		if (top == size_t(-1))
+			return ctx.one();
+
+		const size_t maxWindow = 6;
+		size_t window = powWindowSize(top + 1);
+
+		bigint_t table[1 << (maxWindow - 1)];
+		table[0] = base;
+
+		if (window > 1)
+		{
+			bigint_t square = ctx.sqrmod(base);
+			for (size_t n = 1; n < (size_t(1) << (window - 1)); n++)
+				table[n] = ctx.mulmod(table[n - 1], square);
+		}
+
+		bigint_t result;
+		bool started = false;
+
+		for (int i = int(top); i >= 0;)
+		{
+			if (!exp.getBit(i))
+			{
+				if (started)
+					result = ctx.sqrmod(result);
+				i--;
+				continue;
+			}
+
+			// longest window ending in a 1 bit
+			int j = std::max(i - int(window) + 1, 0);
+			while (!exp.getBit(j))
+				j++;
+
+			mathprim::u32 value = 0;
+			for (int n = i; n >= j; n--)
+				value = (value << 1) | (exp.getBit(n) ? 1 : 0);
+
+			if (started)
+			{
+				for (int n = i; n >= j; n--)
+					result = ctx.sqrmod(result);
+
+				result = ctx.mulmod(result, table[value >> 1]);
+			}
+			else
+			{
+				result = table[value >> 1];
+				started = true;
+			}
+
+			i = j - 1;
+		}
+
+		return result;
+	}
+
+	// base^exp mod m. Odd moduli run in Montgomery form so the loop has no divisions
+	template <size_t numwords, typename limb_t>
+	bigint<numwords, false, limb_t> powmod (const bigint<numwords, false, limb_t>& base, const bigint<numwords, false, limb_t>& exp, const bigint<numwords, false, limb_t>& mod)
+	{
+		typedef bigint<numwords, false, limb_t> bigint_t;
+
+		if (mod == 0)
+			throw std::invalid_argument("Divide By Zero");
+
+		if (mod == 1)
+			return bigint_t(0);
+
+		if (mod.getWord(0) & 1)
+		{
+			montgomery_context<bigint_t> ctx (mod);
+			return ctx.fromMontgomery(slidingWindowPow(ctx, ctx.toMontgomery(base), exp));
+		}
+
+		division_context<bigint_t> ctx (mod);
+		return slidingWindowPow(ctx, base % mod, exp);
+	}
+
+	// base^exp, wrapping on overflow like operator*
+	template <size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> pow (const bigint<numwords, issigned, limb_t>& base, unsigned int exp)
+	{
+		typedef bigint<numwords, issigned, limb_t> bigint_t;
+		return slidingWindowPow(wrapping_context<bigint_t>(), base, bigint_t(exp));
+	}
+
+	// ==============================================================
+	//      Roots
+	// ==============================================================
+
+	// an estimate of x^(1/k) from above, good to 40 bits: the double root of x's top 52
+	// bits at a shift that is a multiple of k, scaled up before truncating so the integer
+	// keeps the double's precision
+	template <typename bigint_t>
+	bigint_t rootEstimate (const bigint_t& x, unsigned int k)
+	{
+		size_t bits  = x.indexMSB() + 1;
+		size_t shift = bits > 52 ? (bits - 52 + k - 1) / k * k : 0;
+		size_t scale = std::min(shift / k, size_t(52 - 52 / k));
+
+		bigint_t top = x >> shift;
+		double root = std::pow (top.getWord(0) + 4294967296.0 * top.getWord(1) + 1, 1.0 / k);
+		root = std::ldexp (root, int(scale)) * (1 + 1.0 / (1ull << 40));
+
+		return bigint_t(__int64(root) + 1) << (shift / k - scale);
+	}
+
+	// floor(x^(1/k)). Newton's s' = ((k - 1) s + x / s^(k-1)) / k from above stays above
+	// the root, so it runs until the estimate's precision covers the root's bits and a
+	// product or two settles the last ulps, rather than a final division to see it stop
+	template <unsigned int k, size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> iroot (const bigint<numwords, issigned, limb_t>& x)
+	{
+		static_assert(k > 0, "Zeroth Root");
+		typedef bigint<numwords, issigned, limb_t> bigint_t;
+		typedef typename bigint_t::wide_t wide_t;
+
+		if (issigned && x.isNegative())
+			throw std::out_of_range("Argument Out Of Range");
+
+		if (k == 1 || x == 0)
+			return x;
+
+		bigint_t s = rootEstimate (x, k);
+		size_t bits = x.indexMSB() + 1;
+		size_t loss = mathprim::indexMSB(mathprim::u32(k)) + 1;
+
+		for (size_t precision = 40; precision < bits / k + 1; precision = 2 * precision - loss)
+		{
+			bigint_t power = s;
+			for (unsigned int i = 2; i < k; i++)
+				power *= s;
+
+			s = (s * bigint_t(int(k - 1)) + x / power) / bigint_t(int(k));
+		}
+
+		wide_t wx = x.template cast<wide_t>();
+		for (;;)
+		{
+			bigint_t power = s;
+			for (unsigned int i = 2; i < k; i++)
+				power *= s;
+
+			if (bigint_t::mulFull (power, s) <= wx)
+				return s;
+
+			s -= 1;
+		}
+	}
+
+	// floor(sqrt(x))
+	template <size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> isqrt (const bigint<numwords, issigned, limb_t>& x)
+	{
+		return iroot<2> (x);
+	}
+
+	// bit r set for each square r mod m
+	template <unsigned int m>
+	struct square_residues
+	{
+		mathprim::u64 bits[(m + 63) / 64] = {};
+
+		constexpr square_residues ()
+		{
+			for (unsigned int i = 0; i < m; i++)
+				bits[i * i % m / 64] |= mathprim::u64(1) << (i * i % m % 64);
+		}
+
+		constexpr bool contains (unsigned int r) const
+		{
+			return (bits[r / 64] >> (r % 64)) & 1;
+		}
+	};
+
+	// residues mod 256 and mod 63, 65, 17 and 241 pass about 1 non square in 250 on to the root
+	template <size_t numwords, bool issigned, typename limb_t>
+	bool isPerfectSquare (const bigint<numwords, issigned, limb_t>& x)
+	{
+		static constexpr square_residues<256> mod256;
+		static constexpr square_residues<63>  mod63;
+		static constexpr square_residues<65>  mod65;
+		static constexpr square_residues<17>  mod17;
+		static constexpr square_residues<241> mod241;
+
+		if (issigned && x.isNegative())
+			return false;
+
+		if (!mod256.contains(x.getWord(0) & 0xff))
+			return false;
+
+		// x mod 2^24 - 1 = 9 * 5 * 7 * 13 * 17 * 241, without a division: 2^32 is
+		// 2^8 mod 2^24 - 1, so word n weighs 2^(8n mod 24)
+		mathprim::u64 sum = 0;
+		for (size_t n = 0; n < numwords; n++)
+			sum += mathprim::u64(x.getWord(n)) << (8 * (n % 3));
+
+		unsigned int r = unsigned int(sum % 0xffffff);
+		if (!mod63.contains(r % 63) || !mod65.contains(r % 65) || !mod17.contains(r % 17) || !mod241.contains(r % 241))
+			return false;
+
+		bigint<numwords, issigned, limb_t> root = isqrt (x);
+		return root * root == x;
+	}
+
+	// ==============================================================
+	//      GCD
+	// ==============================================================
+
+	// Stein's binary gcd, for values that fit 64 bits
+	inline mathprim::u64 binaryGcd (mathprim::u64 u, mathprim::u64 v)
+	{
+		if (u == 0 || v == 0)
+			return u | v;
+
+		int shift = std::countr_zero(u | v);
+		u >>= std::countr_zero(u);
+		do
+		{
+			v >>= std::countr_zero(v);
+			if (u > v)
+				std::swap(u, v);
+			v -= u;
+		}
+		while (v != 0);
+
+		return u << shift;
+	}
+
+	// Lehmer's gcd on the words of unsigned magnitudes. The leading 62 bits of u and v
+	// (Knuth's algorithm L, on two word digits) run single precision Euclid steps while
+	// they provably match the true quotients, then the steps go onto u and v as one 2x2
+	// matrix of entries below 2^31. Cofactors of consecutive remainders alternate in
+	// sign, so only their magnitudes are kept, and the step count's parity for the sign.
+	// Without a cofactor, values down to 64 bits finish with a binary gcd
+	template <typename bigint_t>
+	class euclid
+	{
+		public:
+			static const size_t numwords = bigint_t::size_words;
+
+			// gcd(a, b) and, given x, the magnitude of the cofactor of a in a x + b y = gcd
+			// and whether it is negative
+			static bigint_t gcd (const bigint_t& a, const bigint_t& b, bigint_t* x = nullptr, bool* negative = nullptr)
+			{
+				bigint_t r[4] = {a, b, bigint_t(0), bigint_t(0)};
+				bigint_t s[4] = {bigint_t(1), bigint_t(0), bigint_t(0), bigint_t(0)};
+
+				mathprim::u32* u  = r[0].m_words;
+				mathprim::u32* v  = r[1].m_words;
+				mathprim::u32* t  = r[2].m_words;
+				mathprim::u32* w  = r[3].m_words;
+				mathprim::u32* su = s[0].m_words;
+				mathprim::u32* sv = s[1].m_words;
+				mathprim::u32* st = s[2].m_words;
+				mathprim::u32* sw = s[3].m_words;
+				bool odd = false;
+
+				// a < b: the first step only swaps them
+				if (kernels::compare(u, v, numwords) < 0)
+				{
+					std::swap(u, v);
+					std::swap(su, sv);
+					odd = true;
+				}
+
+				size_t n = kernels::significantWords(u, numwords);
+				for (;;)
+				{
+					size_t nv = kernels::significantWords(v, n);
+					if (nv == 0)
+						break;
+
+					if (!x && n <= 2)
+					{
+						mathprim::u64 g = binaryGcd (word64 (u, n), word64 (v, nv));
+						bigint_t result (0);
+						result.m_words[0] = mathprim::u32(g);
+						if (numwords > 1)
+							result.m_words[1] = mathprim::u32(g >> 32);
+						return result;
+					}
+
+					size_t bits  = n * 32 - mathprim::numLeadingZeros(u[n - 1]);
+					size_t shift = bits > 62 ? bits - 62 : 0;
+
+					__int64 uh = __int64(bitsAt (u, n, shift));
+					__int64 vh = __int64(bitsAt (v, n, shift));
+					__int64 A = 1, B = 0, C = 0, D = 1;
+					size_t steps = 0;
+
+					while (vh + C > 0 && vh + D > 0)
+					{
+						__int64 q = (uh + A) / (vh + C);
+						if (q != (uh + B) / (vh + D) || q > 0x7fffffff)
+							break;
+
+						__int64 nextC = A - q * C;
+						__int64 nextD = B - q * D;
+						if (nextC < -0x7fffffff || nextC > 0x7fffffff || nextD < -0x7fffffff || nextD > 0x7fffffff)
+							break;
+
+						__int64 nextV = uh - q * vh;
+						A = C;  C = nextC;
+						B = D;  D = nextD;
+						uh = vh; vh = nextV;
+						steps++;
+					}
+
+					if (B == 0)
+					{
+						// the digits can't tell the quotient: one full Euclid step
+						mathprim::u32 q[numwords + 1];
+						mathprim::u32 scratch[2 * numwords + 1];
+
+						kernels::zero(t, numwords);
+						if (nv == 1)
+							t[0] = kernels::divmod1(q, u, n, v[0]);
+						else
+							kernels::divmod(q, t, u, n, v, nv, scratch);
+
+						if (x)
+						{
+							size_t nq = kernels::significantWords(q, n - nv + 1);
+							mathprim::u32 product[2 * numwords + 1];
+							kernels::zero(product, numwords);
+							if (nq)
+								kernels::mulBasecase(product, q, nq, sv, numwords - nq + 1);
+							kernels::copy(st, su, numwords);
+							kernels::addTo(st, numwords, product, numwords);
+						}
+
+						rotate (u, v, t);
+						rotate (su, sv, st);
+						odd = !odd;
+					}
+					else
+					{
+						// u' = A u + B v and v' = C u + D v, where A, D and B, C have the
+						// opposite signs of an even or odd count of steps
+						mathprim::u32 a0 = mathprim::u32(A < 0 ? -A : A);
+						mathprim::u32 b0 = mathprim::u32(B < 0 ? -B : B);
+						mathprim::u32 c0 = mathprim::u32(C < 0 ? -C : C);
+						mathprim::u32 d0 = mathprim::u32(D < 0 ? -D : D);
+
+						if (steps & 1)
+						{
+							kernels::mulSubMul1(t, v, b0, u, a0, n);
+							kernels::mulSubMul1(w, u, c0, v, d0, n);
+						}
+						else
+						{
+							kernels::mulSubMul1(t, u, a0, v, b0, n);
+							kernels::mulSubMul1(w, v, d0, u, c0, n);
+						}
+						kernels::zero(t + n, numwords - n);
+						kernels::zero(w + n, numwords - n);
+
+						if (x)
+						{
+							kernels::mulAddMul1(st, su, a0, sv, b0, numwords);
+							kernels::mulAddMul1(sw, su, c0, sv, d0, numwords);
+							std::swap(su, st);
+							std::swap(sv, sw);
+						}
+
+						std::swap(u, t);
+						std::swap(v, w);
+						odd = odd != ((steps & 1) != 0);
+					}
+
+					n = kernels::significantWords(u, n);
+				}
+
+				if (x)
+				{
+					kernels::copy(x->m_words, su, numwords);
+					*negative = odd && kernels::significantWords(su, numwords) != 0;
+				}
+
+				bigint_t result;
+				kernels::copy(result.m_words, u, numwords);
+				return result;
+			}
+
+		private:
+			static mathprim::u64 word64 (const mathprim::u32* a, size_t n)
+			{
+				return n > 1 ? (mathprim::u64(a[1]) << 32) | a[0] : a[0];
+			}
+
+			// 64 bits of a from bit shift up
+			static mathprim::u64 bitsAt (const mathprim::u32* a, size_t n, size_t shift)
+			{
+				size_t i = shift / 32;
+				size_t bits = shift % 32;
+
+				mathprim::u64 low  = (mathprim::u64(i + 1 < n ? a[i + 1] : 0) << 32) | a[i];
+				mathprim::u64 high = i + 2 < n ? a[i + 2] : 0;
+				return bits ? (low >> bits) | (high << (64 - bits)) : low;
+			}
+
+			// (a, b, c) = (b, c, a)
+			static void rotate (mathprim::u32*& a, mathprim::u32*& b, mathprim::u32*& c)
+			{
+				mathprim::u32* first = a;
+				a = b;
+				b = c;
+				c = first;
+			}
+	};
+
+	template <size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> gcd (const bigint<numwords, issigned, limb_t>& a, const bigint<numwords, issigned, limb_t>& b)
+	{
+		typedef bigint<numwords, issigned, limb_t> bigint_t;
+		return euclid<bigint_t>::gcd ((issigned && a.isNegative()) ? -a : a, (issigned && b.isNegative()) ? -b : b);
+	}
+
+	// wrapping on overflow like operator*
+	template <size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> lcm (const bigint<numwords, issigned, limb_t>& a, const bigint<numwords, issigned, limb_t>& b)
+	{
+		typedef bigint<numwords, issigned, limb_t> bigint_t;
+
+		if (a == 0 || b == 0)
+			return bigint_t(0);
+
+		bigint_t ma = (issigned && a.isNegative()) ? -a : a;
+		bigint_t mb = (issigned && b.isNegative()) ? -b : b;
+		return ma / euclid<bigint_t>::gcd (ma, mb) * mb;
+	}
+
+	// g = gcd(a, b) with a x + b y = g. The cofactors are Euclid's, |x| <= b / 2g and
+	// |y| <= a / 2g, so fit the type as signed values; unsigned types hold them as two's
+	// complement
+	template <size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> xgcd (const bigint<numwords, issigned, limb_t>& a, const bigint<numwords, issigned, limb_t>& b,
+		bigint<numwords, issigned, limb_t>& x, bigint<numwords, issigned, limb_t>& y)
+	{
+		typedef bigint<numwords, issigned, limb_t> bigint_t;
+		typedef bigint<numwords, false, limb_t> magnitude_t;
+		typedef bigint<2 * numwords, false> wide_t;
+
+		bool aneg = issigned && a.isNegative();
+		bool bneg = issigned && b.isNegative();
+		magnitude_t ma = (aneg ? -a : a).template cast<magnitude_t>();
+		magnitude_t mb = (bneg ? -b : b).template cast<magnitude_t>();
+
+		magnitude_t mx;
+		bool xneg = false;
+		magnitude_t g = euclid<magnitude_t>::gcd (ma, mb, &mx, &xneg);
+
+		// b y = g - a x, in the double width
+		magnitude_t my (0);
+		bool yneg = false;
+		if (mb != 0)
+		{
+			wide_t ax = ma.template cast<wide_t>() * mx.template cast<wide_t>();
+			wide_t gw = g.template cast<wide_t>();
+			wide_t numerator;
+			if (xneg)
+				numerator = ax + gw;
+			else if (ax >= gw)
+			{
+				numerator = ax - gw;
+				yneg = true;
+			}
+			else
+				numerator = gw - ax;
+			my = (numerator / mb.template cast<wide_t>()).template cast<magnitude_t>();
+		}
+
+		x = mx.template cast<bigint_t>();
+		y = my.template cast<bigint_t>();
+		if (xneg != aneg)
+			x = -x;
+		if (yneg != bneg)
+			y = -y;
+
+		return g.template cast<bigint_t>();
+	}
+
+	// a^-1 mod m, in [0, m), for m > 0
+	template <size_t numwords, bool issigned, typename limb_t>
+	bigint<numwords, issigned, limb_t> modInverse (const bigint<numwords, issigned, limb_t>& a, const bigint<numwords, issigned, limb_t>& m)
+	{
+		typedef bigint<numwords, issigned, limb_t> bigint_t;
+
+		if (m == 0)
+			throw std::invalid_argument("Divide By Zero");
+		if (issigned && m.isNegative())
+			throw std::invalid_argument("Negative Modulus");
+
+		bool aneg = issigned && a.isNegative();
+		bigint_t r = (aneg ? -a : a) % m;
+		if (aneg && r != 0)
+			r = m - r;
+
+		bigint_t x;
+		bool negative = false;
+		if (euclid<bigint_t>::gcd (r, m, &x, &negative) != 1)
+			throw std::invalid_argument("Not Invertible");
+
+		return negative ? m - x : x;
+	}
+}
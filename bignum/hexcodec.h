@@ -0,0 +1,112 @@
+#pragma once
+
+#include <ctype.h>
+
+#include "mathprimatives.h"
+#include "kernels.h"
+
+namespace bignum
+{
+	// ==============================================================
+	//      hexadecimal codec
+	// ==============================================================
+	//
+	// Word arrays to and from hex digits, most significant digit first.
+	// On x86-64 eight bytes (sixteen digits) go through each SSE2 step.
+
+	namespace kernels
+	{
+		// out[0..8) = hex digits of w
+		inline void hexEncodeWord (char* out, u32 w)
+		{
+			for (size_t n = 8; n-- > 0; w >>= 4)
+				out[n] = "0123456789abcdef"[w & 0xf];
+		}
+
+		// w = the n (<= 8) hex digits at in, returns false on a non hex character
+		inline bool hexDecodeWord (const char* in, size_t n, u32& w)
+		{
+			w = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				if (!isxdigit((unsigned char)(in[i])))
+					return false;
+				w = (w << 4) | mathprim::hexCharTou32(in[i]);
+			}
+			return true;
+		}
+
+#ifdef BIGNUM_X86_KERNELS
+		// out[0..16) = hex digits of v
+		inline void hexEncode64 (char* out, u64 v)
+		{
+			// big endian bytes, split into high and low nibbles and interleaved
+			__m128i bytes   = _mm_cvtsi64_si128((long long)(mathprim::byteSwap64(v)));
+			__m128i hi      = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f));
+			__m128i lo      = _mm_and_si128(bytes, _mm_set1_epi8(0x0f));
+			__m128i nibbles = _mm_unpacklo_epi8(hi, lo);
+
+			// '0' + n, and 'a' - '0' - 10 more for n > 9
+			__m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+			_mm_storeu_si128((__m128i*)(out), _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters));
+		}
+
+		// v = the 16 hex digits at in, returns false on a non hex character
+		inline bool hexDecode64 (const char* in, u64& v)
+		{
+			__m128i c     = _mm_loadu_si128((const __m128i*)(in));
+			__m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+
+			__m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+			__m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+			if (_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xffff)
+				return false;
+
+			// digits already have bit 5 set, so lower - '0' works for both, less 39 for letters
+			__m128i nibbles = _mm_sub_epi8(_mm_sub_epi8(lower, _mm_set1_epi8('0')), _mm_and_si128(isAlpha, _mm_set1_epi8('a' - '0' - 10)));
+
+			// each 16 bit lane holds (high nibble, low nibble) of one byte
+			__m128i hi    = _mm_and_si128(nibbles, _mm_set1_epi16(0x00ff));
+			__m128i lo    = _mm_srli_epi16(nibbles, 8);
+			__m128i bytes = _mm_packus_epi16(_mm_or_si128(_mm_slli_epi16(hi, 4), lo), _mm_setzero_si128());
+
+			v = mathprim::byteSwap64(u64(_mm_cvtsi128_si64(bytes)));
+			return true;
+		}
+#endif
+
+		// out[0..8n) = hex digits of a[0..n)
+		inline void hexEncode (char* out, const u32* a, size_t n)
+		{
+			size_t i = n;
+#ifdef BIGNUM_X86_KERNELS
+			for (; i >= 2; i -= 2, out += 16)
+				hexEncode64 (out, (u64(a[i - 1]) << 32) | a[i - 2]);
+#endif
+			for (; i > 0; i--, out += 8)
+				hexEncodeWord (out, a[i - 1]);
+		}
+
+		// a[0..n) = the 8n hex digits at in, returns false on a non hex character
+		inline bool hexDecode (u32* a, const char* in, size_t n)
+		{
+			size_t i = n;
+#ifdef BIGNUM_X86_KERNELS
+			for (; i >= 2; i -= 2, in += 16)
+			{
+				u64 v;
+				if (!hexDecode64 (in, v))
+					return false;
+				a[i - 1] = u32(v >> 32);
+				a[i - 2] = u32(v);
+			}
+#endif
+			for (; i > 0; i--, in += 8)
+				if (!hexDecodeWord (in, 8, a[i - 1]))
+					return false;
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,782 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <ctype.h>
+
+#include "mathprimatives.h"
+#include "kernels.h"
+#include "hexcodec.h"
+#include "bigint.h"
+#include "allocator.h"
+
+// words held in the object itself before an integer moves to the heap
+#ifndef BIGNUM_INTEGER_INLINE_WORDS
+#define BIGNUM_INTEGER_INLINE_WORDS 8
+#endif
+
+namespace bignum
+{
+	// ==============================================================
+	//      integer
+	// ==============================================================
+	//
+	// Signed integer of any size, set at run time. Sign and magnitude: the
+	// magnitude is m_size significant words, LSW first, so zero has no words
+	// and is never negative. Up to BIGNUM_INTEGER_INLINE_WORDS words live in
+	// the object, longer values in blocks from allocator_t (see allocator.h);
+	// a move takes the block rather than copying it. The arithmetic runs the
+	// bigint word kernels on the (pointer, length) spans of the magnitudes,
+	// with scratch from allocator_t::buffer.
+
+	template <typename allocator_t = pooled_allocator>
+	class basic_integer
+	{
+		public:
+			typedef basic_integer<allocator_t> this_t;
+			typedef allocator_t allocator_type;
+			static const size_t inline_words = BIGNUM_INTEGER_INLINE_WORDS;
+
+		private:
+			mathprim::u32* m_words;
+			size_t m_size;
+			size_t m_capacity;
+			bool m_negative;
+			mathprim::u32 m_inline[inline_words];
+
+			// room for words words, keeping the current value
+			void reserve (size_t words)
+			{
+				if (words <= m_capacity)
+					return;
+
+				size_t capacity;
+				mathprim::u32* storage = allocator_t::allocate(std::max(words, m_capacity + m_capacity / 2), capacity);
+				kernels::copy(storage, m_words, m_size);
+
+				release ();
+				m_words = storage;
+				m_capacity = capacity;
+			}
+
+			void release ()
+			{
+				if (m_words != m_inline)
+					allocator_t::deallocate(m_words, m_capacity);
+
+				m_words = m_inline;
+				m_capacity = inline_words;
+			}
+
+			// drop high zero words after an operation wrote n
+			void normalize (size_t n)
+			{
+				m_size = kernels::significantWords(m_words, n);
+				if (m_size == 0)
+					m_negative = false;
+			}
+
+			void setMagnitude (mathprim::u64 value, bool negative)
+			{
+				m_words[0] = mathprim::u32(value);
+				m_words[1] = mathprim::u32(value >> 32);
+				m_negative = negative;
+				normalize (2);
+			}
+
+			// ==============================================================
+			//      Utility Functions
+			// ==============================================================
+			//
+			// result may alias any of the operands. The add and subtract passes read
+			// word i of the inputs before writing word i of the result, so they run in
+			// place; multiply and divide build their results in temporaries
+
+			// |result| = |a| + |b|
+			static void addMagnitudes (const this_t& a, const this_t& b, this_t& result)
+			{
+				const this_t& big   = a.m_size >= b.m_size ? a : b;
+				const this_t& small = a.m_size >= b.m_size ? b : a;
+				size_t nb = big.m_size;
+				size_t ns = small.m_size;
+
+				result.reserve (nb + 1);
+				mathprim::u32* r = result.m_words;
+
+				mathprim::u32 carry = kernels::add(r, big.m_words, small.m_words, ns);
+				for (size_t i = ns; i < nb; i++)
+					r[i] = mathprim::addWithCarry(big.m_words[i], mathprim::u32(0), carry);
+				r[nb] = carry;
+
+				result.m_size = nb + carry;
+			}
+
+			// |result| = |a| - |b|, for |a| >= |b|
+			static void subMagnitudes (const this_t& a, const this_t& b, this_t& result)
+			{
+				size_t na = a.m_size;
+				size_t nb = b.m_size;
+
+				result.reserve (na);
+				mathprim::u32* r = result.m_words;
+
+				mathprim::u32 borrow = kernels::sub(r, a.m_words, b.m_words, nb);
+				for (size_t i = nb; i < na; i++)
+					r[i] = mathprim::subWithBorrow(a.m_words[i], mathprim::u32(0), borrow);
+
+				result.normalize (na);
+			}
+
+			// result = a + b, or a - b when subtract is set
+			static void addSigned (const this_t& a, const this_t& b, bool subtract, this_t& result)
+			{
+				bool aneg = a.m_negative;
+				bool bneg = b.m_negative != subtract;
+
+				if (aneg == bneg)
+				{
+					addMagnitudes (a, b, result);
+					result.m_negative = aneg && result.m_size != 0;
+				}
+				else if (compareMagnitudes (a, b) >= 0)
+				{
+					subMagnitudes (a, b, result);
+					result.m_negative = aneg && result.m_size != 0;
+				}
+				else
+				{
+					subMagnitudes (b, a, result);
+					result.m_negative = bneg && result.m_size != 0;
+				}
+			}
+
+			static int compareMagnitudes (const this_t& a, const this_t& b)
+			{
+				if (a.m_size != b.m_size)
+					return a.m_size < b.m_size ? -1 : 1;
+
+				return kernels::compare(a.m_words, b.m_words, a.m_size);
+			}
+
+			// r[0..na+nb) = a * b, na >= nb > 0. Basecase while the shorter operand is
+			// under BIGNUM_KARATSUBA_THRESHOLD words, otherwise the longer operand is cut
+			// into nb word pieces, each a balanced Karatsuba / Toom-3 / NTT multiply
+			static void mulMagnitudes (mathprim::u32* r, const mathprim::u32* a, size_t na, const mathprim::u32* b, size_t nb)
+			{
+				if (nb < BIGNUM_KARATSUBA_THRESHOLD)
+				{
+					kernels::mulBasecase(r, b, nb, a, na);
+					return;
+				}
+
+				typename allocator_t::buffer scratch(3 * nb + kernels::mulScratchWords(nb));
+				mathprim::u32* product = scratch.data();
+				mathprim::u32* piece   = product + 2 * nb;
+				mathprim::u32* tmp     = piece + nb;
+
+				kernels::zero(r, na + nb);
+				for (size_t i = 0; i < na; i += nb)
+				{
+					size_t n = std::min(nb, na - i);
+					if (n < BIGNUM_KARATSUBA_THRESHOLD)
+					{
+						kernels::mulBasecase(product, a + i, n, b, nb);
+					}
+					else if (n == nb)
+					{
+						// a == b stays visible to the squaring path
+						kernels::mul(product, a + i, b, nb, tmp);
+					}
+					else
+					{
+						kernels::copy(piece, a + i, n);
+						kernels::zero(piece + n, nb - n);
+						kernels::mul(product, piece, b, nb, tmp);
+					}
+
+					kernels::addTo(r + i, na + nb - i, product, n + nb);
+				}
+			}
+
+			// truncating like the built in types: the quotient rounds toward zero and the
+			// remainder takes the sign of the dividend
+			static void divmod (const this_t& dividend, const this_t& divisor, this_t* quotient, this_t* remainder)
+			{
+				if (divisor.m_size == 0)
+					throw std::invalid_argument("Divide By Zero");
+
+				size_t n = dividend.m_size;
+				size_t m = divisor.m_size;
+				bool qneg = dividend.m_negative != divisor.m_negative;
+				bool rneg = dividend.m_negative;
+
+				if (compareMagnitudes (dividend, divisor) < 0)
+				{
+					if (remainder)
+						*remainder = dividend;
+					if (quotient)
+						*quotient = this_t();
+					return;
+				}
+
+				this_t q;
+				this_t r;
+				q.reserve (n - m + 1);
+				r.reserve (m);
+
+				if (m == 1)
+				{
+					r.m_words[0] = kernels::divmod1(q.m_words, dividend.m_words, n, divisor.m_words[0]);
+				}
+				else
+				{
+					typename allocator_t::buffer scratch(n + m + 1);
+					kernels::divmod(q.m_words, r.m_words, dividend.m_words, n, divisor.m_words, m, scratch.data());
+				}
+
+				q.m_negative = qneg;
+				q.normalize (n - m + 1);
+				r.m_negative = rneg;
+				r.normalize (m);
+
+				if (quotient)
+					*quotient = std::move(q);
+				if (remainder)
+					*remainder = std::move(r);
+			}
+
+			static void shiftLeft (const this_t& a, size_t bits, this_t& result)
+			{
+				size_t n = a.m_size;
+				if (n == 0)
+				{
+					result = this_t();
+					return;
+				}
+
+				size_t words = bits / 32;
+				bool negative = a.m_negative;
+
+				result.reserve (n + words + 1);
+				mathprim::u32* r = result.m_words;
+
+				// from the top down, so result may alias a
+				size_t shift = bits % 32;
+				r[n + words] = shift ? a.m_words[n - 1] >> (32 - shift) : 0;
+				for (size_t i = n; i-- > 0;)
+				{
+					mathprim::u32 low = (shift && i > 0) ? a.m_words[i - 1] >> (32 - shift) : 0;
+					r[i + words] = (a.m_words[i] << shift) | low;
+				}
+				kernels::zero(r, words);
+
+				result.m_negative = negative;
+				result.normalize (n + words + 1);
+			}
+
+			// rounds toward minus infinity like the signed bigint shift
+			static void shiftRight (const this_t& a, size_t bits, this_t& result)
+			{
+				size_t n = a.m_size;
+				size_t words = bits / 32;
+				bool negative = a.m_negative;
+
+				if (words >= n)
+				{
+					result = negative ? this_t(-1) : this_t();
+					return;
+				}
+
+				// any one bits shifted out of a negative value round the magnitude up
+				bool inexact = false;
+				if (negative)
+				{
+					inexact = kernels::significantWords(a.m_words, words) != 0 || (bits % 32 && (a.m_words[words] << (32 - bits % 32)) != 0);
+				}
+
+				result.reserve (n - words);
+				kernels::shiftRightBits(result.m_words, a.m_words + words, n - words, bits % 32);
+				result.m_negative = negative;
+				result.normalize (n - words);
+
+				if (inexact)
+				{
+					mathprim::u32 carry = 1;
+					for (size_t i = 0; carry && i < result.m_size; i++)
+						result.m_words[i] = mathprim::addWithCarry(result.m_words[i], mathprim::u32(0), carry);
+
+					if (carry)
+					{
+						result.reserve (result.m_size + 1);
+						result.m_words[result.m_size++] = carry;
+					}
+					result.m_negative = true;
+				}
+			}
+
+			static const mathprim::u32 group_size = 1000000000;
+			static const size_t group_shift = mathprim::leadingZeros(group_size);
+			static const mathprim::u32 group_normalized = group_size << group_shift;
+			static const mathprim::u32 group_reciprocal = mathprim::reciprocalWord(group_normalized);
+
+		public:
+
+			basic_integer () : m_words(m_inline), m_size(0), m_capacity(inline_words), m_negative(false)
+			{
+			}
+
+			basic_integer (int value) : basic_integer()
+			{
+				setMagnitude (value < 0 ? 0 - mathprim::u64(value) : mathprim::u64(value), value < 0);
+			}
+
+			basic_integer (__int64 value) : basic_integer()
+			{
+				setMagnitude (value < 0 ? 0 - mathprim::u64(value) : mathprim::u64(value), value < 0);
+			}
+
+			basic_integer (unsigned int value) : basic_integer()
+			{
+				setMagnitude (value, false);
+			}
+
+			basic_integer (unsigned __int64 value) : basic_integer()
+			{
+				setMagnitude (value, false);
+			}
+
+			// the value of a fixed width bigint, signed or not
+			template <size_t numwords, bool issigned, typename limb_t>
+			explicit basic_integer (const bigint<numwords, issigned, limb_t>& value) : basic_integer()
+			{
+				bool negative = issigned && value.isNegative();
+				bigint<numwords, issigned, limb_t> magnitude = negative ? -value : value;
+
+				reserve (numwords);
+				for (size_t i = 0; i < numwords; i++)
+					m_words[i] = magnitude.getWord(i);
+
+				m_negative = negative;
+				normalize (numwords);
+			}
+
+			basic_integer (const this_t& value) : basic_integer()
+			{
+				*this = value;
+			}
+
+			basic_integer (this_t&& value) noexcept : basic_integer()
+			{
+				*this = std::move(value);
+			}
+
+			~basic_integer ()
+			{
+				release ();
+			}
+
+			this_t& operator= (const this_t& value)
+			{
+				if (this != &value)
+				{
+					m_size = 0;
+					reserve (value.m_size);
+					kernels::copy(m_words, value.m_words, value.m_size);
+					m_size = value.m_size;
+					m_negative = value.m_negative;
+				}
+				return *this;
+			}
+
+			// takes value's heap block; an inline value is copied
+			this_t& operator= (this_t&& value) noexcept
+			{
+				if (this == &value)
+					return *this;
+
+				if (value.m_words != value.m_inline)
+				{
+					release ();
+					m_words = value.m_words;
+					m_capacity = value.m_capacity;
+					value.m_words = value.m_inline;
+					value.m_capacity = inline_words;
+				}
+				else
+				{
+					// an inline value fits whatever storage this already has
+					kernels::copy(m_words, value.m_words, value.m_size);
+				}
+
+				m_size = value.m_size;
+				m_negative = value.m_negative;
+				value.m_size = 0;
+				value.m_negative = false;
+				return *this;
+			}
+
+			// the low bits of the value in two's complement, as bigint::cast
+			template <typename bigint_t>
+			bigint_t cast () const
+			{
+				size_t words = bigint_t::size_words;
+
+				bigint_t result(0);
+				for (size_t i = 0; i < std::min(m_size, words); i++)
+					result.setWord(i, m_words[i]);
+
+				return m_negative ? -result : result;
+			}
+
+			static void add (const this_t& a, const this_t& b, this_t& result)
+			{
+				addSigned (a, b, false, result);
+			}
+
+			static void sub (const this_t& a, const this_t& b, this_t& result)
+			{
+				addSigned (a, b, true, result);
+			}
+
+			static void mul (const this_t& a, const this_t& b, this_t& result)
+			{
+				if (a.m_size == 0 || b.m_size == 0)
+				{
+					result = this_t();
+					return;
+				}
+
+				this_t product;
+				product.reserve (a.m_size + b.m_size);
+
+				if (a.m_size >= b.m_size)
+					mulMagnitudes (product.m_words, a.m_words, a.m_size, b.m_words, b.m_size);
+				else
+					mulMagnitudes (product.m_words, b.m_words, b.m_size, a.m_words, a.m_size);
+
+				product.m_negative = a.m_negative != b.m_negative;
+				product.normalize (a.m_size + b.m_size);
+				result = std::move(product);
+			}
+
+			static void div (const this_t& a, const this_t& b, this_t& quotient, this_t& remainder)
+			{
+				divmod (a, b, &quotient, &remainder);
+			}
+
+			// return < 0 if a < b;  0 if a == b; > 0 if a > b
+			static int compare (const this_t& a, const this_t& b)
+			{
+				if (a.m_negative != b.m_negative)
+					return a.m_negative ? -1 : 1;
+
+				int c = compareMagnitudes (a, b);
+				return a.m_negative ? -c : c;
+			}
+
+			std::string toDecString () const
+			{
+				if (m_size == 0)
+					return "0";
+
+				// 32 bits are under 10 decimal digits
+				typename allocator_t::buffer scratch(m_size);
+				mathprim::u32* value = scratch.data();
+				kernels::copy(value, m_words, m_size);
+
+				std::string buffer(m_size * 10 + 1, '\0');
+				char* end = buffer.data() + buffer.size();
+				char* pos = end;
+
+				size_t n = m_size;
+				while (n > 0)
+				{
+					mathprim::u32 group = kernels::divmod1Preinv(value, value, n, group_normalized, group_shift, group_reciprocal);
+					n = kernels::significantWords(value, n);
+
+					pos = mathprim::writeDecimal(pos, group, n ? 9 : mathprim::decimalDigits(group));
+				}
+
+				if (m_negative) *--pos = '-';
+
+				return std::string(pos, end);
+			}
+
+			// [-]hex digits without leading zeros
+			std::string toHexString () const
+			{
+				if (m_size == 0)
+					return "0";
+
+				std::string buffer(m_size * 8, '0');
+				kernels::hexEncode(buffer.data(), m_words, m_size);
+
+				size_t first = buffer.find_first_not_of('0');
+				return (m_negative ? "-" : "") + buffer.substr(first);
+			}
+
+			static this_t fromDecString (std::string& str)
+			{
+				return fromDecString (str.c_str());
+			}
+
+			// as bigint::fromDecString, eight digits at a time onto the significant words
+			static this_t fromDecString (const char* str)
+			{
+				bool isneg = false;
+
+				if (*str == '-')
+				{
+					isneg = true;
+					str++;
+				}
+
+				size_t length = strlen(str);
+
+				// 10^length < 2^(10 length / 3)
+				this_t value;
+				value.reserve (length * 10 / 96 + 2);
+
+				mathprim::u32 head = 0;
+				for (size_t n = length % 8; n > 0; n--, str++)
+				{
+					if (!isdigit((unsigned char)(*str)))
+						throw std::invalid_argument("Invalid Decimal Digit");
+					head = head * 10 + mathprim::u32(*str - '0');
+				}
+
+				value.m_words[0] = head;
+				value.m_size = head ? 1 : 0;
+
+				for (size_t n = length / 8; n > 0; n--, str += 8)
+				{
+					mathprim::u32 group;
+					if (!mathprim::parseEightDigits(str, group))
+						throw std::invalid_argument("Invalid Decimal Digit");
+
+					mathprim::u32 carry = kernels::mulAdd1(value.m_words, value.m_size, 100000000, group);
+					if (carry)
+						value.m_words[value.m_size++] = carry;
+				}
+
+				value.m_negative = isneg && value.m_size != 0;
+				return value;
+			}
+
+			static this_t fromHexString (std::string& str)
+			{
+				return fromHexString (str.c_str());
+			}
+
+			static this_t fromHexString (const char* str)
+			{
+				bool isneg = false;
+
+				if (*str == '-')
+				{
+					isneg = true;
+					str++;
+				}
+
+				if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+					str += 2;
+				else
+					throw std::invalid_argument("Invalid Hexadecimal Format");
+
+				size_t length = strlen(str);
+				size_t words = length / 8;
+				size_t head = length % 8;
+
+				this_t value;
+				value.reserve (words + 1);
+				value.m_words[words] = 0;
+
+				if ((head && !kernels::hexDecodeWord(str, head, value.m_words[words])) || !kernels::hexDecode(value.m_words, str + head, words))
+					throw std::invalid_argument("Invalid Hexadecimal Digit");
+
+				value.m_negative = isneg;
+				value.normalize (words + 1);
+				return value;
+			}
+
+			bool isNegative () const
+			{
+				return m_negative;
+			}
+
+			bool isZero () const
+			{
+				return m_size == 0;
+			}
+
+			// number of significant words in the magnitude
+			size_t sizeWords () const
+			{
+				return m_size;
+			}
+
+			// word wordIndex of the magnitude, 0 above the significant words
+			mathprim::u32 getWord (size_t wordIndex) const
+			{
+				return wordIndex < m_size ? m_words[wordIndex] : 0;
+			}
+
+	// ==============================================================
+	//      operators
+	// ==============================================================
+	//
+	// The && overloads work in the storage of a temporary left operand, so
+	// a + b + c allocates once
+
+			this_t operator+ (const this_t& value) const &
+			{
+				this_t result;
+				add (*this, value, result);
+				return result;
+			}
+
+			this_t operator+ (const this_t& value) &&
+			{
+				add (*this, value, *this);
+				return std::move(*this);
+			}
+
+			this_t operator- (const this_t& value) const &
+			{
+				this_t result;
+				sub (*this, value, result);
+				return result;
+			}
+
+			this_t operator- (const this_t& value) &&
+			{
+				sub (*this, value, *this);
+				return std::move(*this);
+			}
+
+			this_t operator- () const &
+			{
+				this_t result = *this;
+				result.m_negative = !m_negative && m_size != 0;
+				return result;
+			}
+
+			this_t operator- () &&
+			{
+				m_negative = !m_negative && m_size != 0;
+				return std::move(*this);
+			}
+
+			this_t operator* (const this_t& value) const
+			{
+				this_t result;
+				mul (*this, value, result);
+				return result;
+			}
+
+			this_t operator/ (const this_t& value) const
+			{
+				this_t quotient;
+				divmod (*this, value, &quotient, nullptr);
+				return quotient;
+			}
+
+			this_t operator% (const this_t& value) const
+			{
+				this_t remainder;
+				divmod (*this, value, nullptr, &remainder);
+				return remainder;
+			}
+
+			this_t operator<< (size_t shift) const
+			{
+				this_t result;
+				shiftLeft (*this, shift, result);
+				return result;
+			}
+
+			this_t operator>> (size_t shift) const
+			{
+				this_t result;
+				shiftRight (*this, shift, result);
+				return result;
+			}
+
+			this_t& operator+= (const this_t& value)
+			{
+				add (*this, value, *this);
+				return *this;
+			}
+
+			this_t& operator-= (const this_t& value)
+			{
+				sub (*this, value, *this);
+				return *this;
+			}
+
+			this_t& operator*= (const this_t& value)
+			{
+				mul (*this, value, *this);
+				return *this;
+			}
+
+			this_t& operator/= (const this_t& value)
+			{
+				divmod (*this, value, this, nullptr);
+				return *this;
+			}
+
+			this_t& operator%= (const this_t& value)
+			{
+				divmod (*this, value, nullptr, this);
+				return *this;
+			}
+
+			this_t& operator<<= (size_t shift)
+			{
+				shiftLeft (*this, shift, *this);
+				return *this;
+			}
+
+			this_t& operator>>= (size_t shift)
+			{
+				shiftRight (*this, shift, *this);
+				return *this;
+			}
+
+			bool operator == (const this_t& value) const
+			{
+				return compare(*this, value) == 0;
+			}
+
+			bool operator != (const this_t& value) const
+			{
+				return compare(*this, value) != 0;
+			}
+
+			bool operator <  (const this_t& value) const
+			{
+				return compare(*this, value) < 0;
+			}
+
+			bool operator >  (const this_t& value) const
+			{
+				return compare(*this, value) > 0;
+			}
+
+			bool operator <= (const this_t& value) const
+			{
+				return compare(*this, value) <= 0;
+			}
+
+			bool operator >= (const this_t& value) const
+			{
+				return compare(*this, value) >= 0;
+			}
+	};
+
+	typedef basic_integer<> integer;
+}
@@ -0,0 +1,846 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+
+#include "mathprimatives.h"
+
+// crossover points, in 32 bit words, between the multiplication algorithms.
+// Karatsuba needs at least 2 words and Toom-3 at least 16; the number
+// theoretic transform takes over at run time from BIGNUM_NTT_THRESHOLD.
+#ifndef BIGNUM_KARATSUBA_THRESHOLD
+#define BIGNUM_KARATSUBA_THRESHOLD 20
+#endif
+
+#ifndef BIGNUM_TOOM3_THRESHOLD
+#define BIGNUM_TOOM3_THRESHOLD 64
+#endif
+
+#ifndef BIGNUM_NTT_THRESHOLD
+#define BIGNUM_NTT_THRESHOLD 512
+#endif
+
+namespace bignum
+{
+	// ==============================================================
+	//      word array kernels
+	// ==============================================================
+	//
+	// Operate on arrays of 32 bit words stored LSW first. Unless noted
+	// the result may alias an input; scratch space is supplied by the
+	// caller so the kernels never allocate. The templated kernels also
+	// run on 64 bit limbs. All of them are constexpr, so bigint arithmetic
+	// can run at compile time; the x86 versions are run time only.
+
+	namespace kernels
+	{
+		using mathprim::u32;
+		using mathprim::u64;
+
+		// number of 64 bit coefficients in the transforms of an n word multiply
+		constexpr size_t nttLength (size_t n)
+		{
+			return std::max(size_t(4), std::bit_ceil(2 * ((n + 1) / 2) - 1));
+		}
+
+		// number of scratch words needed by mul/mulLow for an n word operand. Above
+		// the NTT threshold: five transforms, 8 byte alignment and mulLow's product
+		constexpr size_t mulScratchWords (size_t n)
+		{
+			if (n < BIGNUM_KARATSUBA_THRESHOLD)
+				return 1;
+			if (n < BIGNUM_NTT_THRESHOLD)
+				return 10 * n + 128;
+			return 10 * nttLength(n) + 2 * n + 128;
+		}
+
+		template <size_t n>
+		struct mul_scratch
+		{
+			static const size_t words = mulScratchWords (n);
+		};
+
+		constexpr void copy (u32* r, const u32* a, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+				r[i] = a[i];
+		}
+
+		constexpr void zero (u32* r, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+				r[i] = 0;
+		}
+
+		// number of words (limbs) in a once high zero words are dropped
+		template <typename limb_t>
+		constexpr size_t significantWords (const limb_t* a, size_t n)
+		{
+			while (n > 0 && a[n - 1] == 0)
+				n--;
+			return n;
+		}
+
+		// number of zero bits below the lowest set bit, 32n if a is zero
+		constexpr size_t trailingZeroBits (const u32* a, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+				if (a[i])
+					return i * 32 + mathprim::numTrailingZeros(a[i]);
+			return n * 32;
+		}
+
+		// r = a + b, returns carry
+		template <typename limb_t>
+		constexpr limb_t add (limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+		{
+			limb_t carry = 0;
+			for (size_t i = 0; i < n; i++)
+				r[i] = mathprim::addWithCarry(a[i], b[i], carry);
+			return carry;
+		}
+
+		// r = a - b, returns borrow
+		template <typename limb_t>
+		constexpr limb_t sub (limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+		{
+			limb_t borrow = 0;
+			for (size_t i = 0; i < n; i++)
+				r[i] = mathprim::subWithBorrow(a[i], b[i], borrow);
+			return borrow;
+		}
+
+		// a[0..n) += b[0..m), m <= n, returns carry out of a
+		constexpr u32 addTo (u32* a, size_t n, const u32* b, size_t m)
+		{
+			u32 carry = add (a, a, b, m);
+			for (size_t i = m; carry && i < n; i++)
+				a[i] = mathprim::addWithCarry(a[i], 0, carry);
+			return carry;
+		}
+
+		// a[0..n) -= b[0..m), m <= n, returns borrow out of a
+		constexpr u32 subFrom (u32* a, size_t n, const u32* b, size_t m)
+		{
+			u32 borrow = sub (a, a, b, m);
+			for (size_t i = m; borrow && i < n; i++)
+				a[i] = mathprim::subWithBorrow(a[i], 0, borrow);
+			return borrow;
+		}
+
+		// a = -a (two's complement)
+		constexpr void negate (u32* a, size_t n)
+		{
+			u32 carry = 1;
+			for (size_t i = 0; i < n; i++)
+				a[i] = mathprim::addWithCarry(~a[i], 0, carry);
+		}
+
+		// r = -a (two's complement), r may alias a
+		template <typename limb_t>
+		constexpr void negate (limb_t* r, const limb_t* a, size_t n)
+		{
+			limb_t carry = 1;
+			for (size_t i = 0; i < n; i++)
+				r[i] = mathprim::addWithCarry(limb_t(~a[i]), limb_t(0), carry);
+		}
+
+		// r[0..na) = |a - b|, nb <= na, returns 1 if a < b. r may alias a, not b
+		constexpr u32 absDiff (u32* r, const u32* a, size_t na, const u32* b, size_t nb)
+		{
+			if (r != a)
+				copy (r, a, na);
+
+			u32 borrow = subFrom (r, na, b, nb);
+			if (borrow)
+				negate (r, na);
+
+			return borrow;
+		}
+
+		// a <<= 1, returns the bit shifted out
+		constexpr u32 shiftLeft1 (u32* a, size_t n)
+		{
+			u32 out = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 next = a[i] >> 31;
+				a[i] = (a[i] << 1) | out;
+				out = next;
+			}
+			return out;
+		}
+
+		// a >>= 1, a treated as two's complement (sign bit extended)
+		constexpr void shiftRight1Signed (u32* a, size_t n)
+		{
+			for (size_t i = 0; i < n - 1; i++)
+				a[i] = (a[i] >> 1) | (a[i + 1] << 31);
+			a[n - 1] = u32(mathprim::i32(a[n - 1]) >> 1);
+		}
+
+		// a = a / 3 where a is known to be an exact multiple of 3. Works modulo
+		// 2^(32n), so it is also correct for two's complement values.
+		constexpr void divexactBy3 (u32* a, size_t n)
+		{
+			u32 c = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 s = a[i] - c;
+				c = a[i] < c ? 1 : 0;
+
+				u32 q = s * 0xaaaaaaabU;		// 3^-1 mod 2^32
+				a[i] = q;
+
+				c += (q > 0x55555555U ? 1 : 0) + (q > 0xaaaaaaaaU ? 1 : 0);
+			}
+		}
+
+		// r[0..n) = a << bits, 0 <= bits < 32, returns the bits shifted out
+		constexpr u32 shiftLeftBits (u32* r, const u32* a, size_t n, size_t bits)
+		{
+			if (bits == 0)
+			{
+				copy (r, a, n);
+				return 0;
+			}
+
+			u32 out = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 next = a[i] >> (32 - bits);
+				r[i] = (a[i] << bits) | out;
+				out = next;
+			}
+			return out;
+		}
+
+		// r[0..n) = a >> bits (unsigned), 0 <= bits < limb bits
+		template <typename limb_t>
+		constexpr void shiftRightBits (limb_t* r, const limb_t* a, size_t n, size_t bits)
+		{
+			if (bits == 0)
+			{
+				for (size_t i = 0; i < n; i++)
+					r[i] = a[i];
+				return;
+			}
+
+			for (size_t i = 0; i < n - 1; i++)
+				r[i] = (a[i] >> bits) | (a[i + 1] << (sizeof(limb_t) * 8 - bits));
+			r[n - 1] = a[n - 1] >> bits;
+		}
+
+		// a[0..n) += b[0..n) * q, returns the carry word out of a[n - 1]
+		constexpr u32 addMul1 (u32* a, const u32* b, size_t n, u32 q)
+		{
+			u32 carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 p = mathprim::u64(b[i]) * q + a[i] + carry;
+				a[i] = u32(p);
+				carry = u32(p >> 32);
+			}
+			return carry;
+		}
+
+		// a[0..n) = a * m + c, returns the carry word out of a[n - 1]
+		constexpr u32 mulAdd1 (u32* a, size_t n, u32 m, u32 c)
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 p = mathprim::u64(a[i]) * m + c;
+				a[i] = u32(p);
+				c = u32(p >> 32);
+			}
+			return c;
+		}
+
+		// r[0..n) = a * m, returns the carry word out of r[n - 1]. r may alias a
+		constexpr u32 mul1 (u32* r, const u32* a, size_t n, u32 m)
+		{
+			u32 c = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 p = mathprim::u64(a[i]) * m + c;
+				r[i] = u32(p);
+				c = u32(p >> 32);
+			}
+			return c;
+		}
+
+		// a[0..n) -= b[0..n) * q, returns the word still to be subtracted from a[n]
+		constexpr u32 subMul1 (u32* a, const u32* b, size_t n, u32 q)
+		{
+			u32 carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 p = mathprim::u64(b[i]) * q;
+
+				u32 lo = u32(p) + carry;
+				carry = u32(p >> 32) + (lo < carry ? 1 : 0);
+
+				u32 ai = a[i];
+				a[i] = ai - lo;
+				carry += (a[i] > ai ? 1 : 0);
+			}
+			return carry;
+		}
+
+		// r[0..n) = a * x - b * y, for a difference known to be non negative and to
+		// fit n words. r may alias a or b
+		constexpr void mulSubMul1 (u32* r, const u32* a, u32 x, const u32* b, u32 y, size_t n)
+		{
+			u32 carryA = 0;
+			u32 carryB = 0;
+			u32 borrow = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 pa = mathprim::u64(a[i]) * x + carryA;
+				mathprim::u64 pb = mathprim::u64(b[i]) * y + carryB;
+				carryA = u32(pa >> 32);
+				carryB = u32(pb >> 32);
+
+				mathprim::u64 d = mathprim::u64(u32(pa)) - u32(pb) - borrow;
+				r[i] = u32(d);
+				borrow = u32(d >> 63);
+			}
+		}
+
+		// r[0..n) = a * x + b * y, returns the carry word out of r[n - 1]. r may alias a or b
+		constexpr u32 mulAddMul1 (u32* r, const u32* a, u32 x, const u32* b, u32 y, size_t n)
+		{
+			u32 carryA = 0;
+			u32 carryB = 0;
+			u32 carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 pa = mathprim::u64(a[i]) * x + carryA;
+				mathprim::u64 pb = mathprim::u64(b[i]) * y + carryB;
+				carryA = u32(pa >> 32);
+				carryB = u32(pb >> 32);
+
+				mathprim::u64 s = mathprim::u64(u32(pa)) + u32(pb) + carry;
+				r[i] = u32(s);
+				carry = u32(s >> 32);
+			}
+			return carryA + carryB + carry;
+		}
+
+		// q[0..n) = a / d, returns a % d
+		constexpr u32 divmod1 (u32* q, const u32* a, size_t n, u32 d)
+		{
+			u32 r = 0;
+
+			for (size_t i = n; i-- > 0;)
+			{
+				mathprim::u64 num = (mathprim::u64(r) << 32) | a[i];
+				q[i] = u32(num / d);
+				r = u32(num % d);
+			}
+			return r;
+		}
+
+		// q[0..n) = a / d, returns a % d. d is supplied pre-normalised: dnorm = d << shift
+		// and v = reciprocalWord(dnorm), so each word costs two multiplies and no divide
+		constexpr u32 divmod1Preinv (u32* q, const u32* a, size_t n, u32 dnorm, size_t shift, u32 v)
+		{
+			u32 r = shift ? a[n - 1] >> (32 - shift) : 0;
+
+			for (size_t i = n; i-- > 0;)
+			{
+				u32 word = a[i] << shift;
+				if (shift && i > 0)
+					word |= a[i - 1] >> (32 - shift);
+
+				q[i] = mathprim::divWordPreinv(r, word, dnorm, v, r);
+			}
+			return r >> shift;
+		}
+
+		// return < 0 if a < b;  0 if a == b; > 0 if a > b 
+		template <typename limb_t>
+		constexpr int compare (const limb_t* a, const limb_t* b, size_t n)
+		{
+			for (size_t i = n; i-- > 0;)
+			{
+				if (a[i] < b[i]) return -1;
+				if (a[i] > b[i]) return 1;
+			}
+			return 0;
+		}
+
+		// r[0..na+nb) = a * b, operand scanning for unbalanced sizes. r must not overlap a or b
+		constexpr void mulBasecase (u32* r, const u32* a, size_t na, const u32* b, size_t nb)
+		{
+			zero (r, nb);
+			for (size_t i = 0; i < na; i++)
+				r[i + nb] = addMul1 (r + i, b, nb, a[i]);
+		}
+
+		// Knuth algorithm D. q[0..n-m+1) = a / d, r[0..m) = a % d where d[m-1] != 0,
+		// m >= 2 and n >= m. One quotient word is produced per step from a two word
+		// estimate that is off by at most 2. scratch: n + m + 1 words.
+		// q and r must not overlap a or d
+		constexpr void divmod (u32* q, u32* r, const u32* a, size_t n, const u32* d, size_t m, u32* scratch)
+		{
+			u32* un = scratch;				// normalised dividend, n + 1 words
+			u32* vn = scratch + n + 1;		// normalised divisor, m words
+
+			// shift so the divisor's top bit is set
+			size_t s = mathprim::numLeadingZeros(d[m - 1]);
+			shiftLeftBits (vn, d, m, s);
+			un[n] = shiftLeftBits (un, a, n, s);
+
+			mathprim::u64 vtop = vn[m - 1];
+			mathprim::u64 vnext = vn[m - 2];
+
+			for (size_t j = n - m + 1; j-- > 0;)
+			{
+				mathprim::u64 num = (mathprim::u64(un[j + m]) << 32) | un[j + m - 1];
+
+				mathprim::u64 qhat = num / vtop;
+				mathprim::u64 rhat = num % vtop;
+
+				// refine the estimate with the next divisor word
+				while (qhat > 0xffffffffULL || qhat * vnext > ((rhat << 32) | un[j + m - 2]))
+				{
+					qhat--;
+					rhat += vtop;
+					if (rhat > 0xffffffffULL)
+						break;
+				}
+
+				u32 borrow = subMul1 (un + j, vn, m, u32(qhat));
+				u32 top = un[j + m];
+				un[j + m] = top - borrow;
+
+				// estimate was still one too big, add back
+				if (top < borrow)
+				{
+					qhat--;
+					un[j + m] += add (un + j, un + j, vn, m);
+				}
+
+				q[j] = u32(qhat);
+			}
+
+			shiftRightBits (r, un, m, s);
+			if (s)
+				r[m - 1] |= un[m] << (32 - s);
+		}
+
+		// q[0..n) = a / d for odd d that is known to divide a exactly. Hensel
+		// division from the low end: each quotient word is a[i] * d^-1 mod 2^32, so
+		// no estimates or corrections are needed. Works modulo 2^(32n).
+		// scratch: n words. q may alias a
+		constexpr void divexact (u32* q, const u32* a, size_t n, const u32* d, size_t m, u32* scratch)
+		{
+			u32 dinv = mathprim::inverseMod32(d[0]);
+
+			copy (scratch, a, n);
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 qi = scratch[i] * dinv;
+				size_t len = std::min(m, n - i);
+
+				u32 borrow = subMul1 (scratch + i, d, len, qi);
+				if (i + len < n)
+					subFrom (scratch + i + len, n - i - len, &borrow, 1);
+
+				q[i] = qi;
+			}
+		}
+
+		// true if odd d divides a. Runs the Hensel division and checks that
+		// quotient * d reproduces a without spilling past its top word.
+		// scratch: n + m words
+		constexpr bool divisibleOdd (const u32* a, size_t n, const u32* d, size_t m, u32* scratch)
+		{
+			u32 dinv = mathprim::inverseMod32(d[0]);
+
+			copy (scratch, a, n);
+			zero (scratch + n, m);
+
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 qi = scratch[i] * dinv;
+				u32 borrow = subMul1 (scratch + i, d, m, qi);
+				subFrom (scratch + i + m, n - i, &borrow, 1);
+			}
+
+			return significantWords (scratch + n, m) == 0;
+		}
+
+		// r[0..2n) = a * b, product scanning. r must not overlap a or b
+		template <typename limb_t>
+		constexpr void mulBasecase (limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+		{
+			limb_t c0 = 0;
+			limb_t c1 = 0;
+			limb_t c2 = 0;
+
+			for (size_t k = 0; k < 2 * n - 1; k++)
+			{
+				size_t first = k < n ? 0 : k - n + 1;
+				size_t last  = k < n ? k : n - 1;
+
+				for (size_t i = first; i <= last; i++)
+					mathprim::mulAccumulate(a[i], b[k - i], c0, c1, c2);
+
+				r[k] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+			}
+
+			r[2 * n - 1] = c0;
+		}
+
+		// r[0..n) = a * b mod B^n, product scanning over the columns that fit
+		// in the result only. r must not overlap a or b
+		template <typename limb_t>
+		constexpr void mulLowBasecase (limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+		{
+			limb_t c0 = 0;
+			limb_t c1 = 0;
+			limb_t c2 = 0;
+
+			for (size_t k = 0; k < n; k++)
+			{
+				for (size_t i = 0; i <= k; i++)
+					mathprim::mulAccumulate(a[i], b[k - i], c0, c1, c2);
+
+				r[k] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+			}
+		}
+
+		// r[0..n) = a * b mod B^n for operands of na and nb significant limbs.
+		// Only the columns below na + nb - 1 have products, so small values in
+		// wide types cost a handful of multiplies. r must not overlap a or b
+		template <typename limb_t>
+		constexpr void mulLowBasecase (limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb, size_t n)
+		{
+			limb_t c0 = 0;
+			limb_t c1 = 0;
+			limb_t c2 = 0;
+
+			size_t columns = na && nb ? std::min(na + nb - 1, n) : 0;
+
+			for (size_t k = 0; k < columns; k++)
+			{
+				size_t first = k < nb ? 0 : k - nb + 1;
+				size_t last  = std::min(k, na - 1);
+
+				for (size_t i = first; i <= last; i++)
+					mathprim::mulAccumulate(a[i], b[k - i], c0, c1, c2);
+
+				r[k] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+			}
+
+			// the top column's carry, the product has no more limbs
+			for (size_t k = columns; k < n; k++, c0 = 0)
+				r[k] = c0;
+		}
+
+		// r[0..na + nb - n) ~ a * b / B^n from the columns n - 2 up. The columns left out
+		// sum to under (n - 2) B^(n - 1), so r is at most one below the true value. Nothing
+		// is written when the product is under B^n. r must not overlap a or b
+		template <typename limb_t>
+		constexpr void mulHighBasecase (limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb, size_t n)
+		{
+			if (na == 0 || nb == 0 || na + nb <= n)
+				return;
+
+			limb_t c0 = 0;
+			limb_t c1 = 0;
+			limb_t c2 = 0;
+
+			for (size_t k = n > 2 ? n - 2 : 0; k < na + nb - 1; k++)
+			{
+				size_t first = k < nb ? 0 : k - nb + 1;
+				size_t last  = std::min(k, na - 1);
+
+				for (size_t i = first; i <= last; i++)
+					mathprim::mulAccumulate(a[i], b[k - i], c0, c1, c2);
+
+				if (k >= n)
+					r[k - n] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+			}
+
+			r[na + nb - 1 - n] = c0;
+		}
+
+		// r[0..n) += a * b mod B^n, operand scanning: one row r[i..n) += a * b[i]
+		// per word of b, each with its own carry chain, so there is never a
+		// separate product to add. r must not overlap a or b
+		template <typename limb_t>
+		constexpr void addMulLowBasecase (limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				limb_t carry = 0;
+				for (size_t j = 0; j < n - i; j++)
+				{
+					// r + carry + a.b < B^2, so the top accumulator word stays 0
+					limb_t c1 = 0;
+					limb_t c2 = 0;
+					limb_t c0 = mathprim::addWithCarry(r[i + j], carry, c1);
+					mathprim::mulAccumulate(a[j], b[i], c0, c1, c2);
+
+					r[i + j] = c0;
+					carry = c1;
+				}
+			}
+		}
+
+		// r[0..2n) = a * a. Each cross product a[i].a[j], i < j, is formed once and
+		// doubled, then the diagonal squares are added. r must not overlap a
+		constexpr void sqrBasecase (u32* r, const u32* a, size_t n)
+		{
+			zero (r, 2 * n);
+			for (size_t i = 0; i + 1 < n; i++)
+				r[i + n] = addMul1 (r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+
+			shiftLeft1 (r, 2 * n);
+
+			u32 carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				mathprim::u64 p = mathprim::u64(a[i]) * a[i];
+				r[2 * i]     = mathprim::addWithCarry(r[2 * i], u32(p), carry);
+				r[2 * i + 1] = mathprim::addWithCarry(r[2 * i + 1], u32(p >> 32), carry);
+			}
+		}
+
+		// Montgomery multiplication, coarsely integrated operand scanning (CIOS):
+		// r = a * b * B^-n mod m for a, b < m, m odd and minv = -m^-1 mod 2^32.
+		// Each step adds a * b[i], then a multiple of m that clears the low word,
+		// and shifts down one word. scratch: n + 2 words. r may alias a or b
+		constexpr void montgomeryMul (u32* r, const u32* a, const u32* b, const u32* m, size_t n, u32 minv, u32* t)
+		{
+			zero (t, n + 2);
+
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 carry = 0;
+				t[n] = mathprim::addWithCarry(t[n], addMul1 (t, a, n, b[i]), carry);
+				t[n + 1] = carry;
+
+				u32 u = t[0] * minv;
+
+				mathprim::u64 p = mathprim::u64(u) * m[0] + t[0];
+
+				for (size_t j = 1; j < n; j++)
+				{
+					p = mathprim::u64(u) * m[j] + t[j] + (p >> 32);
+					t[j - 1] = u32(p);
+				}
+
+				carry = 0;
+				t[n - 1] = mathprim::addWithCarry(t[n], u32(p >> 32), carry);
+				t[n] = t[n + 1] + carry;
+			}
+
+			// t < 2m
+			if (t[n] || compare (t, m, n) >= 0)
+				sub (r, t, m, n);
+			else
+				copy (r, t, n);
+		}
+
+		// Montgomery reduction: r = t * B^-n mod m for t[0..2n+1) < m * B^n, with
+		// t[2n] == 0 on entry. t is overwritten.
+		constexpr void montgomeryReduce (u32* r, u32* t, const u32* m, size_t n, u32 minv)
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				u32 carry = addMul1 (t + i, m, n, t[i] * minv);
+				addTo (t + i + n, n - i + 1, &carry, 1);
+			}
+
+			// t / B^n < 2m
+			if (t[2 * n] || compare (t + n, m, n) >= 0)
+				sub (r, t + n, m, n);
+			else
+				copy (r, t + n, n);
+		}
+
+		constexpr void mul (u32* r, const u32* a, const u32* b, size_t n, u32* scratch);
+		inline void mulNTT (u32* r, const u32* a, const u32* b, size_t n, u32* scratch);
+
+		// r[0..2n) = a * b. Splits a = a1.B^l + a0 and uses
+		//   a0.b1 + a1.b0 = a0.b0 + a1.b1 - (a1 - a0)(b1 - b0)
+		// to do three half size multiplies instead of four.
+		constexpr void mulKaratsuba (u32* r, const u32* a, const u32* b, size_t n, u32* scratch)
+		{
+			size_t l = n / 2;
+			size_t h = n - l;
+
+			u32* da = scratch;
+			u32* db = scratch + h;
+			u32* dm = scratch + 2 * h;
+			u32* tmp = scratch + 4 * h;
+
+			u32 sa = absDiff (da, a + l, h, a, l);
+			u32 sb = absDiff (db, b + l, h, b, l);
+
+			mul (r, a, b, l, tmp);						// a0.b0 -> r[0..2l)
+			mul (r + 2 * l, a + l, b + l, h, tmp);		// a1.b1 -> r[2l..2n)
+			mul (dm, da, db, h, tmp);					// |a1 - a0|.|b1 - b0|
+
+			// middle term = a0.b0 + a1.b1 -/+ dm, never negative
+			u32* mid = tmp;
+			copy (mid, r + 2 * l, 2 * h);
+			mid[2 * h] = 0;
+			addTo (mid, 2 * h + 1, r, 2 * l);
+
+			if (sa != sb)
+				addTo (mid, 2 * h + 1, dm, 2 * h);
+			else
+				subFrom (mid, 2 * h + 1, dm, 2 * h);
+
+			addTo (r + l, 2 * n - l, mid, 2 * h + 1);
+		}
+
+		// r[0..2n) = a * b. Toom-3: splits each operand in 3, evaluates at
+		// 0, 1, -1, 2 and infinity, multiplies pointwise and interpolates. The
+		// interpolation works in two's complement.
+		constexpr void mulToom3 (u32* r, const u32* a, const u32* b, size_t n, u32* scratch)
+		{
+			size_t k = (n + 2) / 3;
+			size_t m = n - 2 * k;			// size of the top part
+			size_t e = k + 1;				// size of an evaluated operand
+			size_t L = 2 * e;				// size of a pointwise product
+
+			const u32* a0 = a;
+			const u32* a1 = a + k;
+			const u32* a2 = a + 2 * k;
+			const u32* b0 = b;
+			const u32* b1 = b + k;
+			const u32* b2 = b + 2 * k;
+
+			u32* ea1  = scratch;
+			u32* eb1  = scratch + e;
+			u32* eam1 = scratch + 2 * e;
+			u32* ebm1 = scratch + 3 * e;
+			u32* ea2  = scratch + 4 * e;
+			u32* eb2  = scratch + 5 * e;
+			u32* v1   = scratch + 6 * e;
+			u32* vm1  = v1 + L;
+			u32* v2   = vm1 + L;
+			u32* tmp  = v2 + L;
+
+			// a(1) = a0 + a1 + a2, a(-1) = a0 - a1 + a2, a(2) = a0 + 2.a1 + 4.a2
+			copy (ea1, a0, k);
+			ea1[k] = 0;
+			addTo (ea1, e, a2, m);
+			u32 sam1 = absDiff (eam1, ea1, e, a1, k);
+			addTo (ea1, e, a1, k);
+
+			copy (ea2, a2, m);
+			zero (ea2 + m, e - m);
+			shiftLeft1 (ea2, e);
+			addTo (ea2, e, a1, k);
+			shiftLeft1 (ea2, e);
+			addTo (ea2, e, a0, k);
+
+			copy (eb1, b0, k);
+			eb1[k] = 0;
+			addTo (eb1, e, b2, m);
+			u32 sbm1 = absDiff (ebm1, eb1, e, b1, k);
+			addTo (eb1, e, b1, k);
+
+			copy (eb2, b2, m);
+			zero (eb2 + m, e - m);
+			shiftLeft1 (eb2, e);
+			addTo (eb2, e, b1, k);
+			shiftLeft1 (eb2, e);
+			addTo (eb2, e, b0, k);
+
+			// pointwise products, v(0) and v(inf) go straight into the result
+			zero (r + 2 * k, 2 * k);
+			mul (r, a0, b0, k, tmp);
+			mul (r + 4 * k, a2, b2, m, tmp);
+			mul (v1, ea1, eb1, e, tmp);
+			mul (vm1, eam1, ebm1, e, tmp);
+			mul (v2, ea2, eb2, e, tmp);
+
+			if (sam1 != sbm1)
+				negate (vm1, L);
+
+			const u32* v0   = r;
+			const u32* vinf = r + 4 * k;
+
+			// interpolate, with r(x) = c0 + c1.x + c2.x^2 + c3.x^3 + c4.x^4
+			sub (v2, v2, vm1, L);					// (v2 - vm1) / 3 = c1 + c2 + 3.c3 + 5.c4
+			divexactBy3 (v2, L);
+			sub (vm1, v1, vm1, L);					// (v1 - vm1) / 2 = c1 + c3
+			shiftRight1Signed (vm1, L);
+			subFrom (v1, L, v0, 2 * k);				// v1 - v0 = c1 + c2 + c3 + c4
+			sub (v2, v2, v1, L);					// c3 + 2.c4
+			shiftRight1Signed (v2, L);
+			sub (v1, v1, vm1, L);					// c2 + c4
+			subFrom (v2, L, vinf, 2 * m);			// c3
+			subFrom (v2, L, vinf, 2 * m);
+			subFrom (v1, L, vinf, 2 * m);			// c2
+			sub (vm1, vm1, v2, L);					// c1
+
+			// recompose, the coefficients are all non negative now
+			addTo (r + k,     2 * n - k,     vm1, std::min(L, 2 * n - k));
+			addTo (r + 2 * k, 2 * n - 2 * k, v1,  std::min(L, 2 * n - 2 * k));
+			addTo (r + 3 * k, 2 * n - 3 * k, v2,  std::min(L, 2 * n - 3 * k));
+		}
+
+		// r[0..2n) = a * b. r must not overlap a or b. Passing a == b squares,
+		// which the NTT does with one forward transform instead of two
+		constexpr void mul (u32* r, const u32* a, const u32* b, size_t n, u32* scratch)
+		{
+			if (n < BIGNUM_KARATSUBA_THRESHOLD)
+				mulBasecase (r, a, b, n);
+			else if (n < BIGNUM_TOOM3_THRESHOLD)
+				mulKaratsuba (r, a, b, n, scratch);
+			else if (n < BIGNUM_NTT_THRESHOLD || std::is_constant_evaluated())
+				mulToom3 (r, a, b, n, scratch);
+			else
+				mulNTT (r, a, b, n, scratch);
+		}
+
+		// r[0..n) = a * b mod 2^(32n). With a = a1.B^h + a0 the low half is
+		//   a0.b0 + B^h (a0.b1 + a1.b0)  mod B^n
+		// where only the low n - h words of the cross products are needed.
+		// r must not overlap a or b
+		constexpr void mulLow (u32* r, const u32* a, const u32* b, size_t n, u32* scratch)
+		{
+			if (n < BIGNUM_KARATSUBA_THRESHOLD)
+			{
+				mulLowBasecase (r, a, b, n);
+				return;
+			}
+
+			size_t h = (n + 1) / 2;
+			size_t l = n - h;
+
+			mul (scratch, a, b, h, scratch + 2 * h);
+			copy (r, scratch, n);
+
+			mulLow (scratch, a, b + h, l, scratch + l);
+			addTo (r + h, l, scratch, l);
+
+			mulLow (scratch, a + h, b, l, scratch + l);
+			addTo (r + h, l, scratch, l);
+		}
+	}
+}
+
+#include "kernels_x86.h"
+#include "kernels_ntt.h"
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mathprimatives.h"
+
+// transform size, in 64 bit elements, from which the remaining stages of a
+// transform run on one block at a time (32 KiB)
+#ifndef BIGNUM_NTT_BLOCK
+#define BIGNUM_NTT_BLOCK 4096
+#endif
+
+namespace bignum
+{
+	// ==============================================================
+	//      number theoretic transform multiply
+	// ==============================================================
+	//
+	// The operands are cut into 64 bit coefficients and convolved modulo three
+	// primes p = k.2^41 + 1 just under 2^62. Their product (~2^186) bounds every
+	// coefficient of the product, and the transform length is limited to 2^41. Each convolution
+	// is a forward transform of both operands (one for a square), a pointwise
+	// product and an inverse transform; Garner's CRT then rebuilds each 192 bit
+	// coefficient and the carries are propagated into the result.
+	//
+	// Arithmetic is Montgomery's with R = 2^64: the roots of unity are held in
+	// Montgomery form, so multiplying a plain value by one gives a plain value.
+	// The forward transform is decimation in frequency (natural order in, bit
+	// reversed out) and the inverse decimation in time (bit reversed in,
+	// natural out), so no permutation pass is needed. Both use radix-4
+	// butterflies, with one radix-2 stage when the length is an odd power of 2.
+	// Above BIGNUM_NTT_BLOCK elements a stage runs over the whole array and the
+	// four quarters then recurse, so below it every remaining stage works on a
+	// block already in cache.
+	//
+	// Run time only: the scratch words are used as 64 bit elements.
+
+	namespace kernels
+	{
+		class ntt_modulus
+		{
+			public:
+				u64 p;
+				u64 pinv;		// p^-1 mod 2^64
+				u64 one;		// R mod p
+				u64 r2;			// R^2 mod p
+				u64 g;			// generator of the multiplicative group
+
+				constexpr ntt_modulus (u64 prime, u64 generator) : p(prime), pinv(prime), one(0), r2(0), g(generator)
+				{
+					// Newton: 3, 6, 12, 24, 48, 96 correct bits
+					for (int i = 0; i < 5; i++)
+						pinv *= 2 - p * pinv;
+
+					one = (0 - p) % p;
+					r2 = one;
+					for (int i = 0; i < 64; i++)
+						r2 = add(r2, r2);
+				}
+
+				constexpr u64 add (u64 a, u64 b) const
+				{
+					u64 s = a + b;
+					return s >= p ? s - p : s;
+				}
+
+				constexpr u64 sub (u64 a, u64 b) const
+				{
+					return a >= b ? a - b : a - b + p;
+				}
+
+				// a.b.R^-1 mod p for a, b < p
+				constexpr u64 mul (u64 a, u64 b) const
+				{
+					u64 hi;
+					u64 lo = mathprim::mul64x64(a, b, hi);
+
+					u64 qh;
+					mathprim::mul64x64(lo * pinv, p, qh);
+					return hi >= qh ? hi - qh : hi - qh + p;
+				}
+
+				constexpr u64 toMontgomery (u64 a) const
+				{
+					return mul(a % p, r2);
+				}
+
+				// a^e, a and the result in Montgomery form
+				constexpr u64 pow (u64 a, u64 e) const
+				{
+					u64 result = one;
+					for (; e; e >>= 1)
+					{
+						if (e & 1)
+							result = mul(result, a);
+						a = mul(a, a);
+					}
+					return result;
+				}
+
+				// a^-1 of a plain value, as a plain value
+				constexpr u64 inverse (u64 a) const
+				{
+					return mul(pow(toMontgomery(a), p - 2), 1);
+				}
+
+				// a mod p for any 64 bit a, p > 2^61
+				constexpr u64 reduce (u64 a) const
+				{
+					while (a >= p)
+						a -= p;
+					return a;
+				}
+		};
+
+		constexpr ntt_modulus ntt_primes[3] =
+		{
+			ntt_modulus (0x3fffc00000000001ULL, 11),
+			ntt_modulus (0x3fffbe0000000001ULL, 3),
+			ntt_modulus (0x3fff840000000001ULL, 19)
+		};
+
+		// Garner's constants, in Montgomery form
+		struct ntt_crt
+		{
+			static constexpr u64 inv01 = ntt_primes[1].toMontgomery(ntt_primes[1].inverse(ntt_primes[0].p % ntt_primes[1].p));
+			static constexpr u64 inv02 = ntt_primes[2].toMontgomery(ntt_primes[2].inverse(ntt_primes[0].p % ntt_primes[2].p));
+			static constexpr u64 inv12 = ntt_primes[2].toMontgomery(ntt_primes[2].inverse(ntt_primes[1].p % ntt_primes[2].p));
+		};
+
+		// roots[h + j] = w^j for w a primitive 2h-th root of unity, or its inverse,
+		// j < h, for every h = 1, 2, 4 .. n/2. Montgomery form
+		inline void nttRoots (u64* roots, size_t n, const ntt_modulus& m, bool inverse)
+		{
+			u64 w = m.pow(m.toMontgomery(m.g), (m.p - 1) / n);
+			if (inverse)
+				w = m.pow(w, n - 1);
+
+			size_t h = n / 2;
+			roots[h] = m.one;
+			for (size_t j = 1; j < h; j++)
+				roots[h + j] = m.mul(roots[h + j - 1], w);
+
+			for (h /= 2; h > 0; h /= 2)
+				for (size_t j = 0; j < h; j++)
+					roots[h + j] = roots[2 * h + 2 * j];
+		}
+
+		// one radix-4 decimation in frequency stage over x[0..s)
+		inline void nttForwardStage (u64* x, size_t s, const u64* roots, const ntt_modulus& m)
+		{
+			size_t q = s / 4;
+			u64 i = roots[3];
+
+			for (size_t j = 0; j < q; j++)
+			{
+				u64 x0 = x[j];
+				u64 x1 = x[j + q];
+				u64 x2 = x[j + 2 * q];
+				u64 x3 = x[j + 3 * q];
+
+				u64 t0 = m.add(x0, x2);
+				u64 t1 = m.add(x1, x3);
+				u64 t2 = m.sub(x0, x2);
+				u64 t3 = m.mul(m.sub(x1, x3), i);
+
+				x[j] = m.add(t0, t1);
+				if (j == 0)
+				{
+					x[q]     = m.sub(t0, t1);
+					x[2 * q] = m.add(t2, t3);
+					x[3 * q] = m.sub(t2, t3);
+				}
+				else
+				{
+					u64 w1 = roots[2 * q + j];
+					u64 w2 = roots[q + j];
+					x[j + q]     = m.mul(m.sub(t0, t1), w2);
+					x[j + 2 * q] = m.mul(m.add(t2, t3), w1);
+					x[j + 3 * q] = m.mul(m.sub(t2, t3), m.mul(w1, w2));
+				}
+			}
+		}
+
+		// one radix-4 decimation in time stage over x[0..s), inverse roots
+		inline void nttInverseStage (u64* x, size_t s, const u64* roots, const ntt_modulus& m)
+		{
+			size_t q = s / 4;
+			u64 i = roots[3];
+
+			for (size_t j = 0; j < q; j++)
+			{
+				u64 a0 = x[j];
+				u64 a1 = x[j + q];
+				u64 a2 = x[j + 2 * q];
+				u64 a3 = x[j + 3 * q];
+
+				if (j != 0)
+				{
+					u64 w1 = roots[2 * q + j];
+					u64 w2 = roots[q + j];
+					a1 = m.mul(a1, w2);
+					a2 = m.mul(a2, w1);
+					a3 = m.mul(a3, m.mul(w1, w2));
+				}
+
+				u64 t0 = m.add(a0, a1);
+				u64 t1 = m.sub(a0, a1);
+				u64 t2 = m.add(a2, a3);
+				u64 t3 = m.mul(m.sub(a2, a3), i);
+
+				x[j]         = m.add(t0, t2);
+				x[j + q]     = m.add(t1, t3);
+				x[j + 2 * q] = m.sub(t0, t2);
+				x[j + 3 * q] = m.sub(t1, t3);
+			}
+		}
+
+		// n a power of 4
+		inline void nttForward4 (u64* x, size_t n, const u64* roots, const ntt_modulus& m)
+		{
+			if (n > BIGNUM_NTT_BLOCK)
+			{
+				nttForwardStage (x, n, roots, m);
+				for (size_t k = 0; k < 4; k++)
+					nttForward4 (x + k * (n / 4), n / 4, roots, m);
+				return;
+			}
+
+			for (size_t s = n; s >= 4; s /= 4)
+				for (size_t i = 0; i < n; i += s)
+					nttForwardStage (x + i, s, roots, m);
+		}
+
+		inline void nttInverse4 (u64* x, size_t n, const u64* roots, const ntt_modulus& m)
+		{
+			if (n > BIGNUM_NTT_BLOCK)
+			{
+				for (size_t k = 0; k < 4; k++)
+					nttInverse4 (x + k * (n / 4), n / 4, roots, m);
+				nttInverseStage (x, n, roots, m);
+				return;
+			}
+
+			for (size_t s = 4; s <= n; s *= 4)
+				for (size_t i = 0; i < n; i += s)
+					nttInverseStage (x + i, s, roots, m);
+		}
+
+		// n a power of 2, at least 4
+		inline void nttForward (u64* x, size_t n, const u64* roots, const ntt_modulus& m)
+		{
+			if (std::countr_zero(n) % 2 == 0)
+			{
+				nttForward4 (x, n, roots, m);
+				return;
+			}
+
+			size_t h = n / 2;
+			for (size_t j = 0; j < h; j++)
+			{
+				u64 u = x[j];
+				u64 v = x[j + h];
+				x[j]     = m.add(u, v);
+				x[j + h] = m.mul(m.sub(u, v), roots[h + j]);
+			}
+
+			nttForward4 (x, h, roots, m);
+			nttForward4 (x + h, h, roots, m);
+		}
+
+		inline void nttInverse (u64* x, size_t n, const u64* roots, const ntt_modulus& m)
+		{
+			if (std::countr_zero(n) % 2 == 0)
+			{
+				nttInverse4 (x, n, roots, m);
+				return;
+			}
+
+			size_t h = n / 2;
+			nttInverse4 (x, h, roots, m);
+			nttInverse4 (x + h, h, roots, m);
+
+			for (size_t j = 0; j < h; j++)
+			{
+				u64 u = x[j];
+				u64 v = m.mul(x[j + h], roots[h + j]);
+				x[j]     = m.add(u, v);
+				x[j + h] = m.sub(u, v);
+			}
+		}
+
+		// x[0..L) = the 64 bit coefficients of a[0..n) mod p, zero padded
+		inline void nttLoad (u64* x, size_t L, const u32* a, size_t n, const ntt_modulus& m)
+		{
+			size_t c = n / 2;
+			for (size_t i = 0; i < c; i++)
+				x[i] = m.reduce((u64(a[2 * i + 1]) << 32) | a[2 * i]);
+
+			if (n % 2)
+				x[c++] = a[n - 1];
+
+			for (size_t i = c; i < L; i++)
+				x[i] = 0;
+		}
+
+		// x = a * b mod p, cyclic of length L, scaled by L / R: the inverse transform
+		// leaves a factor of L and the pointwise Montgomery products one of 1 / R
+		inline void nttConvolve (u64* x, u64* y, u64* roots, size_t L, const u32* a, const u32* b, size_t n, const ntt_modulus& m)
+		{
+			nttRoots (roots, L, m, false);
+
+			nttLoad (x, L, a, n, m);
+			nttForward (x, L, roots, m);
+
+			if (a == b)
+			{
+				for (size_t i = 0; i < L; i++)
+					x[i] = m.mul(x[i], x[i]);
+			}
+			else
+			{
+				nttLoad (y, L, b, n, m);
+				nttForward (y, L, roots, m);
+
+				for (size_t i = 0; i < L; i++)
+					x[i] = m.mul(x[i], y[i]);
+			}
+
+			nttRoots (roots, L, m, true);
+			nttInverse (x, L, roots, m);
+		}
+
+		// r[0..2n) = a * b, a == b takes the squaring path with one forward
+		// transform per prime. scratch: mulScratchWords(n), r must not overlap a or b
+		inline void mulNTT (u32* r, const u32* a, const u32* b, size_t n, u32* scratch)
+		{
+			size_t L = nttLength(n);
+			size_t c = (n + 1) / 2;
+
+			u64* base = reinterpret_cast<u64*>((reinterpret_cast<std::uintptr_t>(scratch) + 7) & ~std::uintptr_t(7));
+			u64* x0 = base;
+			u64* x1 = base + L;
+			u64* x2 = base + 2 * L;
+			u64* y = base + 3 * L;
+			u64* roots = base + 4 * L;
+
+			nttConvolve (x0, y, roots, L, a, b, n, ntt_primes[0]);
+			nttConvolve (x1, y, roots, L, a, b, n, ntt_primes[1]);
+			nttConvolve (x2, y, roots, L, a, b, n, ntt_primes[2]);
+
+			const ntt_modulus& m0 = ntt_primes[0];
+			const ntt_modulus& m1 = ntt_primes[1];
+			const ntt_modulus& m2 = ntt_primes[2];
+
+			// R^2 / L, a Montgomery multiply by it takes out the L / R
+			u64 scale0 = m0.mul(m0.toMontgomery(m0.inverse(L)), m0.r2);
+			u64 scale1 = m1.mul(m1.toMontgomery(m1.inverse(L)), m1.r2);
+			u64 scale2 = m2.mul(m2.toMontgomery(m2.inverse(L)), m2.r2);
+
+			u64 p01hi;
+			u64 p01lo = mathprim::mul64x64(m0.p, m1.p, p01hi);
+
+			// (carry2:carry1:carry0) = product coefficients not yet written
+			u64 carry0 = 0;
+			u64 carry1 = 0;
+			u64 carry2 = 0;
+			for (size_t i = 0; i < 2 * c; i++)
+			{
+				if (i < 2 * c - 1)
+				{
+					u64 v0 = m0.mul(x0[i], scale0);
+					u64 v1 = m1.mul(m1.sub(m1.mul(x1[i], scale1), m1.reduce(v0)), ntt_crt::inv01);
+					u64 v2 = m2.mul(m2.sub(m2.mul(x2[i], scale2), m2.reduce(v0)), ntt_crt::inv02);
+					v2 = m2.mul(m2.sub(v2, m2.reduce(v1)), ntt_crt::inv12);
+
+					// v0 + v1.p0 + v2.p0.p1
+					u64 h1;
+					u64 l1 = mathprim::mul64x64(v1, m0.p, h1);
+					u64 h2;
+					u64 l2 = mathprim::mul64x64(v2, p01lo, h2);
+					u64 h3;
+					u64 l3 = mathprim::mul64x64(v2, p01hi, h3);
+
+					u64 k = 0;
+					carry0 = mathprim::addWithCarry(carry0, v0, k);
+					carry1 = mathprim::addWithCarry(carry1, u64(0), k);
+					carry2 += k;
+
+					k = 0;
+					carry0 = mathprim::addWithCarry(carry0, l1, k);
+					carry1 = mathprim::addWithCarry(carry1, h1, k);
+					carry2 += k;
+
+					k = 0;
+					carry0 = mathprim::addWithCarry(carry0, l2, k);
+					carry1 = mathprim::addWithCarry(carry1, h2, k);
+					carry2 += k;
+
+					k = 0;
+					carry1 = mathprim::addWithCarry(carry1, l3, k);
+					carry2 += h3 + k;
+				}
+
+				if (2 * i < 2 * n)
+					r[2 * i] = u32(carry0);
+				if (2 * i + 1 < 2 * n)
+					r[2 * i + 1] = u32(carry0 >> 32);
+
+				carry0 = carry1;
+				carry1 = carry2;
+				carry2 = 0;
+			}
+		}
+	}
+}
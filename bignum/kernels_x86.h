@@ -0,0 +1,189 @@
+#pragma once
+
+#include "mathprimatives.h"
+
+// x86-64 versions of the 64 bit limb kernels. add / sub use the adc / sbb
+// intrinsics, which every x86-64 has. The multiply uses BMI2 (mulx) and ADX
+// (adcx / adox) when the CPU reports them at run time, otherwise the portable
+// product scanning kernel. Define BIGNUM_NO_X86_KERNELS to use the portable
+// kernels only.
+#if !defined(BIGNUM_NO_X86_KERNELS) && (defined(__x86_64__) || defined(_M_X64))
+#define BIGNUM_X86_KERNELS 1
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BIGNUM_TARGET_BMI2_ADX
+#define BIGNUM_TARGET_AVX2
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#define BIGNUM_TARGET_BMI2_ADX __attribute__((target("bmi2,adx")))
+#define BIGNUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace bignum
+{
+	// ==============================================================
+	//      CPU feature detection
+	// ==============================================================
+
+	namespace cpu
+	{
+		struct features
+		{
+			bool bmi2;
+			bool adx;
+			bool avx2;
+		};
+
+		// regs = eax, ebx, ecx, edx
+		inline void cpuid (unsigned int leaf, unsigned int subleaf, unsigned int* regs)
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuidex(info, int(leaf), int(subleaf));
+			for (int n = 0; n < 4; n++)
+				regs[n] = (unsigned int)(info[n]);
+#else
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		}
+
+		// XCR0, the register state the OS saves on a context switch
+		inline mathprim::u64 xcr0 ()
+		{
+#ifdef _MSC_VER
+			return _xgetbv(0);
+#else
+			unsigned int lo, hi;
+			__asm__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			return (mathprim::u64(hi) << 32) | lo;
+#endif
+		}
+
+		inline features detectFeatures ()
+		{
+			unsigned int leaf0[4];
+			unsigned int leaf1[4] = { 0, 0, 0, 0 };
+			unsigned int leaf7[4] = { 0, 0, 0, 0 };
+
+			cpuid (0, 0, leaf0);
+			if (leaf0[0] >= 1)
+				cpuid (1, 0, leaf1);
+			if (leaf0[0] >= 7)
+				cpuid (7, 0, leaf7);
+
+			// AVX state has to be enabled by the OS (OSXSAVE, XCR0 bits 1 and 2)
+			bool osAvx = (leaf1[2] & (1 << 27)) != 0 && (xcr0() & 6) == 6;
+
+			features f;
+			f.bmi2 = (leaf7[1] & (1 << 8)) != 0;
+			f.adx  = (leaf7[1] & (1 << 19)) != 0;
+			f.avx2 = osAvx && (leaf7[1] & (1 << 5)) != 0;
+			return f;
+		}
+
+		// detected once, on first use
+		inline const features& getFeatures ()
+		{
+			static const features f = detectFeatures();
+			return f;
+		}
+	}
+
+	namespace kernels
+	{
+		typedef unsigned long long ull;
+
+		// r = a + b, returns carry. One adc per limb
+		inline u64 add (u64* r, const u64* a, const u64* b, size_t n)
+		{
+			unsigned char carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				ull t;
+				carry = _addcarry_u64(carry, a[i], b[i], &t);
+				r[i] = t;
+			}
+			return carry;
+		}
+
+		// r = a - b, returns borrow. One sbb per limb
+		inline u64 sub (u64* r, const u64* a, const u64* b, size_t n)
+		{
+			unsigned char borrow = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				ull t;
+				borrow = _subborrow_u64(borrow, a[i], b[i], &t);
+				r[i] = t;
+			}
+			return borrow;
+		}
+
+		// r[0..n) += a * b mod B^n, operand scanning with one row per b[i]. Within
+		// a row mulx leaves the flags alone, so the low halves of the products are
+		// added on the adcx (CF) chain and the high halves of the previous
+		// products on the adox (OF) chain, with no carry word in between.
+		// r must not overlap a or b
+		BIGNUM_TARGET_BMI2_ADX
+		inline void addMulLowBasecaseAdx (u64* r, const u64* a, const u64* b, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				u64* row = r + i;
+				ull bi = b[i];
+				ull hi = 0;
+				unsigned char cf = 0;
+				unsigned char of = 0;
+
+				for (size_t j = 0; j < n - i; j++)
+				{
+					ull nexthi;
+					ull lo = _mulx_u64(a[j], bi, &nexthi);
+
+					ull t;
+					cf = _addcarryx_u64(cf, row[j], lo, &t);
+					of = _addcarryx_u64(of, t, hi, &t);
+					row[j] = t;
+					hi = nexthi;
+				}
+			}
+		}
+
+		// r[0..n) = a * b mod B^n
+		BIGNUM_TARGET_BMI2_ADX
+		inline void mulLowBasecaseAdx (u64* r, const u64* a, const u64* b, size_t n)
+		{
+			for (size_t i = 0; i < n; i++)
+				r[i] = 0;
+
+			addMulLowBasecaseAdx (r, a, b, n);
+		}
+
+		// r[0..n) += a * b mod B^n on 64 bit limbs, mulx / adx when available
+		inline void addMulLowBasecase (u64* r, const u64* a, const u64* b, size_t n)
+		{
+			const cpu::features& f = cpu::getFeatures();
+
+			if (n > 2 && f.bmi2 && f.adx)
+				addMulLowBasecaseAdx (r, a, b, n);
+			else
+				addMulLowBasecase<u64> (r, a, b, n);
+		}
+
+		// r[0..n) = a * b mod B^n on 64 bit limbs, mulx / adx when available. For
+		// two limbs the call into the separately targeted kernel costs more than it saves
+		inline void mulLowBasecase (u64* r, const u64* a, const u64* b, size_t n)
+		{
+			const cpu::features& f = cpu::getFeatures();
+
+			if (n > 2 && f.bmi2 && f.adx)
+				mulLowBasecaseAdx (r, a, b, n);
+			else
+				mulLowBasecase<u64> (r, a, b, n);
+		}
+	}
+}
+
+#endif
@@ -1,5 +1,21 @@
 #pragma once
 
+#include <cstring>
+#include <type_traits>
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+// a native 64x64->128 bit multiply makes 64 bit limbs worthwhile
+#if defined(__SIZEOF_INT128__)
+#define MATHPRIM_NATIVE_MUL64 1
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define MATHPRIM_NATIVE_MUL64 1
+#else
+#define MATHPRIM_NATIVE_MUL64 0
+#endif
+
 namespace bignum
 {
 	namespace mathprim 
@@ -63,7 +79,7 @@ namespace bignum
 		}
 
 
-		inline size_t numLeadingZeros (unsigned int x) 
+		constexpr size_t numLeadingZeros (unsigned int x) 
 		{
 			size_t n; 
 
@@ -78,11 +94,48 @@ namespace bignum
 		}
 
 		// returns the index of the most significant bit set - or 0xffffffff if no bits set 
-		inline size_t indexMSB (unsigned int x)
+		constexpr size_t indexMSB (unsigned int x)
 		{
 			return 31 - numLeadingZeros (x);
 		}
 
+		constexpr size_t numTrailingZeros (unsigned int x) 
+		{
+			size_t n; 
+
+			if (x == 0) return(32); 
+			n = 0; 
+			if ((x & 0x0000ffff) == 0) {n = n +16; x = x >>16;} 
+			if ((x & 0x000000ff) == 0) {n = n + 8; x = x >> 8;} 
+			if ((x & 0x0000000f) == 0) {n = n + 4; x = x >> 4;} 
+			if ((x & 0x00000003) == 0) {n = n + 2; x = x >> 2;} 
+			n = n + ((x & 1) ^ 1); 
+			return n; 
+		}
+
+		// returns x^-1 mod 2^32 for odd x (Newton iteration, each step doubles the correct bits)
+		constexpr unsigned int inverseMod32 (unsigned int x)
+		{
+			unsigned int inv = x;		// correct to 3 bits since x*x == 1 mod 8
+			inv *= 2 - x * inv;
+			inv *= 2 - x * inv;
+			inv *= 2 - x * inv;
+			inv *= 2 - x * inv;
+			return inv;
+		}
+
+		// compile time leading zero count, used to normalise constant divisors
+		constexpr size_t leadingZeros (u32 x, size_t n = 0)
+		{
+			return (n == 32 || (x & 0x80000000U)) ? n : leadingZeros (x << 1, n + 1);
+		}
+
+		// reciprocal of a normalised (top bit set) divisor: floor((2^64 - 1) / d) - 2^32
+		constexpr u32 reciprocalWord (u32 d)
+		{
+			return u32(~u64(0) / d - (u64(1) << 32));
+		}
+
 		union compound_u64 
 		{
 			struct 
@@ -106,12 +159,97 @@ namespace bignum
 	        return 0;
 	    }
 
-	    inline u32 addWithCarry (u32 a, u32 b, u32& carry)
+	    inline u32 byteSwap32 (u32 x)
 	    {
-	        compound_u64 res;
-	        res.u64_value = u64(a) + u64(b) + u64(carry);
-	        carry = res.u64_value & u64_topmask ? 1 : 0;
-	        return res.lo;
+#if defined(_MSC_VER)
+	        return _byteswap_ulong(x);
+#elif defined(__GNUC__)
+	        return __builtin_bswap32(x);
+#else
+	        return (x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24);
+#endif
+	    }
+
+	    inline u64 byteSwap64 (u64 x)
+	    {
+#if defined(_MSC_VER)
+	        return _byteswap_uint64(x);
+#elif defined(__GNUC__)
+	        return __builtin_bswap64(x);
+#else
+	        return (u64(byteSwap32(u32(x))) << 32) | byteSwap32(u32(x >> 32));
+#endif
+	    }
+
+	    // "00" .. "99", two characters per entry
+	    static const char decimalPairs[] =
+	        "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+	        "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+	    // number of decimal digits in value, at least 1
+	    inline size_t decimalDigits (u32 value)
+	    {
+	        size_t digits = 1;
+	        for (u32 bound = 10; digits < 10 && value >= bound; bound *= 10)
+	            digits++;
+	        return digits;
+	    }
+
+	    // writes value as exactly digits decimal characters ending just before end,
+	    // two at a time from decimalPairs. Returns the first character written
+	    inline char* writeDecimal (char* end, u32 value, size_t digits)
+	    {
+	        for (; digits >= 2; digits -= 2)
+	        {
+	            u32 pair = value % 100;
+	            value /= 100;
+	            end -= 2;
+	            end[0] = decimalPairs[pair * 2];
+	            end[1] = decimalPairs[pair * 2 + 1];
+	        }
+
+	        if (digits)
+	            *--end = char('0' + value);
+
+	        return end;
+	    }
+
+	    // value = the 8 decimal characters at p, all at once in a 64 bit word (SWAR).
+	    // Returns false if any of them is not a digit
+	    inline bool parseEightDigits (const char* p, u32& value)
+	    {
+	        u64 x;
+	        memcpy (&x, p, 8);
+
+	        // every byte 0x30..0x39: high nibble 3, and still 3 after adding 6 to the low nibble
+	        if ((x & 0xf0f0f0f0f0f0f0f0ULL) != 0x3030303030303030ULL || ((x + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) != 0x3030303030303030ULL)
+	            return false;
+
+	        // first character in the low byte: combine neighbouring bytes, then pairs, then quads
+	        x -= 0x3030303030303030ULL;
+	        x = (x * 10 + (x >> 8)) & 0x00ff00ff00ff00ffULL;
+	        x = (x * 100 + (x >> 16)) & 0x0000ffff0000ffffULL;
+	        x = (x * 10000 + (x >> 32)) & 0xffffffffULL;
+
+	        value = u32(x);
+	        return true;
+	    }
+
+	    // the primitives below that kernels use are constexpr, so they work on
+	    // plain u64 arithmetic rather than reading back through compound_u64
+
+	    constexpr u32 addWithCarry (u32 a, u32 b, u32& carry)
+	    {
+	        u64 res = u64(a) + u64(b) + u64(carry);
+	        carry = res & u64_topmask ? 1 : 0;
+	        return u32(res);
+	    }
+
+	    constexpr u32 subWithBorrow (u32 a, u32 b, u32& borrow)
+	    {
+	        u64 res = u64(a) - u64(b) - u64(borrow);
+	        borrow = res & u64_topmask ? 1 : 0;
+	        return u32(res);
 	    }
 
 	    inline compound_u64 mul32x32 (u32 a, u32 b)
@@ -121,6 +259,95 @@ namespace bignum
 	        return res;
 	    }
 
+	    // (c2:c1:c0) += a * b  - 3 word column accumulator used by the product scanning multiply
+	    constexpr void mulAccumulate (u32 a, u32 b, u32& c0, u32& c1, u32& c2)
+	    {
+	        u64 p = u64(a) * u64(b);
+	        u32 carry = 0;
+	        c0 = addWithCarry(c0, u32(p), carry);
+	        c1 = addWithCarry(c1, u32(p >> 32), carry);
+	        c2 += carry;
+	    }
+
+	    // 64 bit limb versions of the above
+
+	    constexpr u64 addWithCarry (u64 a, u64 b, u64& carry)
+	    {
+	        u64 s = a + carry;
+	        u64 c = s < carry ? 1 : 0;
+	        u64 r = s + b;
+	        carry = c | (r < b ? 1 : 0);
+	        return r;
+	    }
+
+	    constexpr u64 subWithBorrow (u64 a, u64 b, u64& borrow)
+	    {
+	        u64 d = a - b;
+	        u64 c = a < b ? 1 : 0;
+	        u64 r = d - borrow;
+	        borrow = c | (d < borrow ? 1 : 0);
+	        return r;
+	    }
+
+	    // returns the low half of a * b, high half in hi
+	    constexpr u64 mul64x64 (u64 a, u64 b, u64& hi)
+	    {
+#if defined(__SIZEOF_INT128__)
+	        unsigned __int128 p = (unsigned __int128)a * b;
+	        hi = u64(p >> 64);
+	        return u64(p);
+#else
+#if MATHPRIM_NATIVE_MUL64
+	        if (!std::is_constant_evaluated())
+	            return _umul128(a, b, &hi);
+#endif
+	        u64 ll = (a & u64_botmask) * (b & u64_botmask);
+	        u64 lh = (a & u64_botmask) * (b >> 32);
+	        u64 hl = (a >> 32) * (b & u64_botmask);
+	        u64 hh = (a >> 32) * (b >> 32);
+
+	        u64 mid = (ll >> 32) + (lh & u64_botmask) + (hl & u64_botmask);
+	        hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	        return (mid << 32) | (ll & u64_botmask);
+#endif
+	    }
+
+	    constexpr void mulAccumulate (u64 a, u64 b, u64& c0, u64& c1, u64& c2)
+	    {
+	        u64 hi;
+	        u64 lo = mul64x64(a, b, hi);
+	        u64 carry = 0;
+	        c0 = addWithCarry(c0, lo, carry);
+	        c1 = addWithCarry(c1, hi, carry);
+	        c2 += carry;
+	    }
+
+	    // returns (u1:u0) / d and sets r to the remainder, using the reciprocal v of the
+	    // normalised divisor d instead of a divide instruction. Requires u1 < d.
+	    // (Moller & Granlund, "Improved division by invariant integers")
+	    constexpr u32 divWordPreinv (u32 u1, u32 u0, u32 d, u32 v, u32& r)
+	    {
+	        u64 q = u64(v) * u1 + ((u64(u1 + 1) << 32) | u0);
+
+	        u32 q1 = u32(q >> 32);
+	        u32 rem = u0 - q1 * d;
+
+	        if (rem > u32(q))
+	        {
+	            q1--;
+	            rem += d;
+	        }
+
+	        if (rem >= d)
+	        {
+	            q1++;
+	            rem -= d;
+	        }
+
+	        r = rem;
+	        return q1;
+	    }
+
 	    // logical shift left
 	    inline compound_u64 LSL (u32 a, size_t bits)
 	    {
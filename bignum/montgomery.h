@@ -0,0 +1,143 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "bigint.h"
+#include "kernels.h"
+
+namespace bignum
+{
+	// ==============================================================
+	//      Montgomery arithmetic
+	// ==============================================================
+	//
+	// Modular arithmetic for a fixed odd modulus m with R = 2^size_bits.
+	// Values are held in Montgomery form (a.R mod m) so that a product is
+	// reduced by a shift instead of a division by m. Convert in with
+	// toMontgomery, work with mulmod / sqrmod / addmod / submod and convert
+	// back with fromMontgomery. Operands must be less than the modulus.
+	// Everything is constexpr, so for a constant modulus R^2 mod m and the
+	// rest of the context can be computed at compile time.
+
+	template <size_t numwords, typename limb_t>
+	class montgomery_context< bigint<numwords, false, limb_t> >
+	{
+		public:
+			typedef bigint<numwords, false, limb_t> bigint_t;
+
+			constexpr montgomery_context (const bigint_t& modulus) : m_modulus(modulus)
+			{
+				if ((modulus.m_words[0] & 1) == 0)
+					throw std::invalid_argument("Montgomery Modulus Must Be Odd");
+
+				m_minv = 0 - mathprim::inverseMod32(modulus.m_words[0]);
+
+				powerOfRadixMod (numwords, m_one);
+				powerOfRadixMod (2 * numwords, m_r2);
+			}
+
+			constexpr const bigint_t& modulus () const
+			{
+				return m_modulus;
+			}
+
+			// R^2 mod m
+			constexpr const bigint_t& rSquared () const
+			{
+				return m_r2;
+			}
+
+			// -m^-1 mod 2^32
+			constexpr mathprim::u32 minv () const
+			{
+				return m_minv;
+			}
+
+			// 1 in Montgomery form (R mod m)
+			constexpr const bigint_t& one () const
+			{
+				return m_one;
+			}
+
+			// a.R mod m, a may be any value
+			constexpr bigint_t toMontgomery (const bigint_t& a) const
+			{
+				return mulmod (a, m_r2);
+			}
+
+			// a.R^-1 mod m
+			constexpr bigint_t fromMontgomery (const bigint_t& a) const
+			{
+				return mulmod (a, bigint_t(1));
+			}
+
+			// a.b.R^-1 mod m
+			constexpr bigint_t mulmod (const bigint_t& a, const bigint_t& b) const
+			{
+				bigint_t result;
+				mathprim::u32 scratch[numwords + 2];
+				kernels::montgomeryMul(result.m_words, a.m_words, b.m_words, m_modulus.m_words, numwords, m_minv, scratch);
+				return result;
+			}
+
+			// a.a.R^-1 mod m, squares with half the word products then reduces
+			constexpr bigint_t sqrmod (const bigint_t& a) const
+			{
+				bigint_t result;
+				mathprim::u32 t[2 * numwords + 1];
+				kernels::sqrBasecase(t, a.m_words, numwords);
+				t[2 * numwords] = 0;
+				kernels::montgomeryReduce(result.m_words, t, m_modulus.m_words, numwords, m_minv);
+				return result;
+			}
+
+			// a + b mod m, also valid for values in Montgomery form
+			constexpr bigint_t addmod (const bigint_t& a, const bigint_t& b) const
+			{
+				bigint_t result;
+				mathprim::u32 carry = kernels::add(result.m_words, a.m_words, b.m_words, numwords);
+
+				if (carry || bigint_t::unsignedCompare(result, m_modulus) >= 0)
+					kernels::sub(result.m_words, result.m_words, m_modulus.m_words, numwords);
+
+				return result;
+			}
+
+			// a - b mod m, also valid for values in Montgomery form
+			constexpr bigint_t submod (const bigint_t& a, const bigint_t& b) const
+			{
+				bigint_t result;
+				mathprim::u32 borrow = kernels::sub(result.m_words, a.m_words, b.m_words, numwords);
+
+				if (borrow)
+					kernels::add(result.m_words, result.m_words, m_modulus.m_words, numwords);
+
+				return result;
+			}
+
+		private:
+			// result = B^words mod m
+			constexpr void powerOfRadixMod (size_t words, bigint_t& result) const
+			{
+				mathprim::u32 num[2 * numwords + 1];
+				mathprim::u32 quotient[2 * numwords + 1];
+				mathprim::u32 scratch[3 * numwords + 2];
+
+				kernels::zero(num, words);
+				num[words] = 1;
+
+				size_t m = kernels::significantWords(m_modulus.m_words, numwords);
+
+				result = 0;
+				if (m == 1)
+					result.m_words[0] = kernels::divmod1(quotient, num, words + 1, m_modulus.m_words[0]);
+				else
+					kernels::divmod(quotient, result.m_words, num, words + 1, m_modulus.m_words, m, scratch);
+			}
+
+			bigint_t m_modulus;
+			bigint_t m_r2;
+			bigint_t m_one;
+			mathprim::u32 m_minv = 0;
+	};
+}
@@ -1,9 +1,11 @@
 
 #include "neo/Logging.h"
 
+#include <cmath>
 #include <limits>
 
 #include "bigfixedTest.h"
+#include "bigfixedmath.h"
 
 
 //CREATE_LOGGING_CATEGORY (test);
@@ -28,6 +30,7 @@ namespace neo
 		testShift ();
 		testMul ();
 		testDiv ();
+		testMath ();
 
 		LOGMSG (INFO, "");
 		LOGMSG (INFO, neo::makeString("************************************************************"));
@@ -93,6 +96,23 @@ namespace neo
 
 		v = fixed_128_64 (-2000.123456);
 		double d = v.toDouble();
+
+		v = fixed_128_64::fromDecString("-1000.125");
+		verify ("fromDecString -1000.125", v == fixed_128_64(-1000.125));
+
+		v = fixed_128_64::fromDecString("0.0001220703125");
+		verify ("fromDecString 0.0001220703125", v == fixed_128_64(0.0001220703125));
+
+		char buffer[fixed_128_64::maxChars()];
+		std::to_chars_result tc = to_chars(buffer, buffer + sizeof(buffer), fixed_128_64(-1000.125));
+		verify ("to_chars -1000.125", tc.ec == std::errc() && std::string(buffer, tc.ptr) == "-1000.125");
+
+		tc = to_chars(buffer, buffer + 4, fixed_128_64(-1000.125));
+		verify ("to_chars too small", tc.ec == std::errc::value_too_large);
+
+		const char text[] = "12.5e3";
+		std::from_chars_result fc = from_chars(text, text + 6, v);
+		verify ("from_chars 12.5", fc.ec == std::errc() && fc.ptr == text + 4 && v == fixed_128_64(12.5));
 	}
 
 	void bigfixedTest::testCompare()
@@ -117,6 +137,14 @@ namespace neo
 	void bigfixedTest::testAddSub()
 	{
 		TRACE_FUNCTION();
+
+		verify ("add: 1.5 + -2.25", (fixed_128_64(1.5) + fixed_128_64(-2.25)).toDecString() == "-0.75");
+		verify ("sub: 1.5 - -2.25", (fixed_128_64(1.5) - fixed_128_64(-2.25)).toDecString() == "3.75");
+
+		fixed_128_64 v(100);
+		v += fixed_128_64(0.5);
+		v -= fixed_128_64(1000);
+		verify ("add/sub: in place", v.toDecString() == "-899.5");
 	}
 
 	void bigfixedTest::testShift()
@@ -128,11 +156,84 @@ namespace neo
 	void bigfixedTest::testMul()
 	{
 		TRACE_FUNCTION();
+
+		verify ("mul: 1.5 * -2.25", (fixed_128_64(1.5) * fixed_128_64(-2.25)).toDecString() == "-3.375");
+		verify ("mul: -0.125 * -1000", (fixed_128_64(-0.125) * fixed_128_64(-1000)).toDecString() == "125.0");
+
+		// wide enough for the double width product to use Toom-3
+		typedef bigfixed<24, 24> fixed_768_768;
+		verify ("mul: 1.5 * -2.25 (Toom-3)", (fixed_768_768(1.5) * fixed_768_768(-2.25)).toDouble() == -3.375);
 	}
 
 	void bigfixedTest::testDiv()
 	{
 		TRACE_FUNCTION();
+
+		verify ("div: -7.5 / 2.5", fixed_128_64(-7.5) / fixed_128_64(2.5) == fixed_128_64(-3));
+		verify ("div: 1 / 1024", (fixed_128_64(1) / fixed_128_64(1024)).toDecString() == "0.0009765625");
+		verify ("div: 1 / 3", fixed_128_64(1) / fixed_128_64(3) == fixed_128_64::fromDecString("0.33333333333333333331527"));
+
+		fixed_128_64 d = fixed_128_64::fromDecString("-1234.5678");
+		fixed_128_64::reciprocal_t inverse = d.reciprocal();
+		verify ("reciprocal: multiply", fixed_128_64(1000000) * inverse == fixed_128_64(1000000) / d && fixed_128_64(0.001) * inverse == fixed_128_64(0.001) / d);
+		verify ("reciprocal: value", fixed_128_64(4).reciprocal().value() == fixed_128_64(0.25));
+
+		bool divideByZero = false;
+		try
+		{
+			fixed_128_64(1).reciprocal();
+			fixed_128_64(0).reciprocal();
+		}
+		catch (std::invalid_argument&)
+		{
+			divideByZero = true;
+		}
+		verify ("reciprocal: divide by zero", divideByZero);
+	}
+
+	// within a few ulps of the truncated decimal
+	template <typename T>
+	static bool near (const T& value, const std::string& expected)
+	{
+		T diff = value - T::fromDecString(expected);
+		T tolerance = T(std::ldexp(1.0, 2 - int(T::size_bits_frac)));
+		return diff <= tolerance && -diff <= tolerance;
+	}
+
+	void bigfixedTest::testMath()
+	{
+		TRACE_FUNCTION();
+
+		typedef fixed_functions<fixed_128_64> functions;
+
+		verify ("math: pi", near(functions::pi(), "3.14159265358979323846264338327950288"));
+		verify ("math: pi (128 fraction bits)", near(fixed_functions<fixed_128_128>::pi(), "3.14159265358979323846264338327950288419716940"));
+		verify ("math: ln2", near(functions::ln2(), "0.693147180559945309417232121458176568"));
+
+		verify ("math: sqrt 16", sqrt(fixed_128_64(16)) == fixed_128_64(4));
+		verify ("math: sqrt 0.25", sqrt(fixed_128_64(0.25)) == fixed_128_64(0.5));
+		verify ("math: sqrt 2 truncated", sqrt(fixed_128_64(2)) * sqrt(fixed_128_64(2)) <= fixed_128_64(2));
+		verify ("math: rsqrt 4", rsqrt(fixed_128_64(4)) == fixed_128_64(0.5));
+
+		verify ("math: exp 1", near(exp(fixed_128_64(1)), "2.71828182845904523536028747135266249"));
+		verify ("math: exp 1 (128 fraction bits)", near(exp(fixed_128_128(1)), "2.71828182845904523536028747135266249775724709"));
+		verify ("math: exp -1", near(exp(fixed_128_64(-1)), "0.367879441171442321595523770161460867"));
+		verify ("math: exp 0", exp(fixed_128_64(0)) == fixed_128_64(1));
+		verify ("math: log 10", near(log(fixed_128_64(10)), "2.30258509299404568401799145468436420"));
+		verify ("math: log 1", log(fixed_128_64(1)) == fixed_128_64(0));
+
+		verify ("math: sin 1", near(sin(fixed_128_64(1)), "0.841470984807896506652502321630298999"));
+		verify ("math: cos 1", near(cos(fixed_128_64(1)), "0.540302305868139717400936607442976603"));
+		verify ("math: sin -pi/6", near(sin(-functions::pi() / fixed_128_64(6)), "-0.5"));
+		verify ("math: cos 1000 pi", near(cos(functions::pi() * fixed_128_64(1000)), "1.0"));
+		verify ("math: atan 0.5", near(atan(fixed_128_64(0.5)), "0.463647609000806116214256231461214402"));
+		verify ("math: atan -1", near(atan(fixed_128_64(-1)), "-0.785398163397448309615660845819875721"));
+
+		int outOfRange = 0;
+		try { sqrt(fixed_128_64(-1)); } catch (std::out_of_range&) { outOfRange++; }
+		try { log(fixed_128_64(0)); }   catch (std::out_of_range&) { outOfRange++; }
+		try { exp(fixed_128_64(100)); } catch (std::out_of_range&) { outOfRange++; }
+		verify ("math: out of range", outOfRange == 3);
 	}
 
 }
@@ -25,6 +25,7 @@ namespace neo
 			void testShift ();
 			void testMul ();
 			void testDiv ();
+			void testMath ();
 
 		public:
 			bigfixedTest ();
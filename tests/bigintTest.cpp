@@ -1,7 +1,11 @@
 
+#include <vector>
+
 #include "neo/Logging.h"
 
 #include "bigintTest.h"
+#include "bigintmath.h"
+#include "bigint_batch.h"
 
 
 CREATE_LOGGING_CATEGORY (test);
@@ -26,6 +30,10 @@ namespace neo
 		testShift ();
 		testMul ();
 		testDiv ();
+		testModular ();
+		testRoots ();
+		testGcd ();
+		testBatch ();
 
 		LOGMSG (INFO, "");
 		LOGMSG (INFO, neo::makeString("************************************************************"));
@@ -78,6 +86,24 @@ namespace neo
 
 		mathprim::compound_u64 mulres = mathprim::mul32x32(0x123456, 0x1234);
 		verify("mul32x32", mulres.u64_value == 0x14B60AD78LL);
+
+		mathprim::u32 c0 = 0xffffffff;
+		mathprim::u32 c1 = 0xffffffff;
+		mathprim::u32 c2 = 0;
+		mathprim::mulAccumulate(0xffffffff, 0xffffffff, c0, c1, c2);
+		verify ("mulAccumulate", c0 == 0 && c1 == 0xfffffffe && c2 == 1);
+
+		mathprim::u64 hi;
+		mathprim::u64 lo = mathprim::mul64x64(0xffffffffffffffffULL, 0xffffffffffffffffULL, hi);
+		verify ("mul64x64", lo == 1 && hi == 0xfffffffffffffffeULL);
+
+		mathprim::u64 carry64 = 1;
+		mathprim::u64 sum64 = mathprim::addWithCarry(mathprim::u64(0xffffffffffffffffULL), mathprim::u64(0), carry64);
+		verify ("addWithCarry 64, carry", sum64 == 0 && carry64 == 1);
+
+		mathprim::u64 borrow64 = 1;
+		mathprim::u64 diff64 = mathprim::subWithBorrow(mathprim::u64(0), mathprim::u64(0), borrow64);
+		verify ("subWithBorrow 64, borrow", diff64 == 0xffffffffffffffffULL && borrow64 == 1);
 	}
 
 	void bigintTest::testInitialise()
@@ -128,6 +154,89 @@ namespace neo
 		d = int128::fromDecString("1237612627387465253764");
 		verify ("fromDecString +ve", d.toDecString() == "1237612627387465253764");
 
+		verify ("fromDecString 19 digits", uint128::fromDecString("9999999999999999999") == uint128(unsigned __int64(9999999999999999999ULL)));
+		verify ("fromDecString leading zeros", uint128::fromDecString("00000000000000000000000000000042") == 42);
+		verify ("fromDecString wraps", uint128::fromDecString("340282366920938463463374607431768211457") == 1);
+
+		bool digitExcept = false;
+		try
+		{
+			int128::fromDecString("12345678901234567890123x5678901234567890");
+		}
+		catch (std::invalid_argument&)
+		{
+			digitExcept = true;
+		}
+		verify ("fromDecString invalid digit", digitExcept);
+
+		verify ("toDecString 0", int128(0).toDecString() == "0");
+		verify ("toDecString 10^9", int128(1000000000).toDecString() == "1000000000");
+		verify ("toDecString unsigned max", uint128(-1).toDecString() == "340282366920938463463374607431768211455");
+		verify ("toDecString signed min", (int128(1) << 127).toDecString() == "-170141183460469231731687303715884105728");
+
+		using namespace bignum::literals;
+
+		constexpr uint256 hexLiteral = 0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed_u256;
+		constexpr int256 decLiteral = -57896044618658097711785492504343953926634992332820282019728792003956564819949_i256;
+		constexpr uint128 folded = (1'000'000_u128 * 0xffffffffffffffff_u128 + 7_u128) / 1000_u128;
+		verify ("literal: _u256 hex", hexLiteral == uint256::fromHexString("0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed"));
+		verify ("literal: _i256 decimal", decLiteral == -hexLiteral.cast<int256>());
+		verify ("literal: constexpr arithmetic", folded.toDecString() == "18446744073709551615000");
+
+		uint128 wire = uint128::fromHexString("0x00112233445566778899aabbccddeeff");
+		std::byte bytes[uint128::size_bytes * 2];
+
+		wire.toBytes(bytes, std::endian::big);
+		verify ("toBytes big endian", bytes[0] == std::byte(0x00) && bytes[1] == std::byte(0x11) && bytes[15] == std::byte(0xff));
+		verify ("fromBytes big endian", uint128::fromBytes(std::span<const std::byte>(bytes, 16), std::endian::big) == wire);
+
+		wire.toBytes(bytes, std::endian::little);
+		verify ("toBytes little endian", bytes[0] == std::byte(0xff) && bytes[15] == std::byte(0x00));
+		verify ("fromBytes little endian", uint128::fromBytes(std::span<const std::byte>(bytes, 16), std::endian::little) == wire);
+		verify ("fromBytes short", uint128::fromBytes(std::span<const std::byte>(bytes, 3), std::endian::big) == 0xffeedd);
+
+		uint128 values[2] = { wire, ~wire };
+		uint128 decoded[2];
+		uint128::toBytes(values, bytes, std::endian::big);
+		uint128::fromBytes(bytes, std::endian::big, decoded);
+		verify ("toBytes / fromBytes batch", decoded[0] == values[0] && decoded[1] == values[1] && bytes[16] == std::byte(0xff));
+
+		verify ("digitCount 0", int128(0).digitCount() == 1);
+		verify ("digitCount 10^9 - 1", int128(999999999).digitCount() == 9);
+		verify ("digitCount 10^9", int128(1000000000).digitCount() == 10);
+		verify ("digitCount unsigned max", uint128(-1).digitCount() == 39);
+		verify ("digitCount hex", int128(-0x12345).digitCount(16) == 5);
+		verify ("maxCharsFor", int128::maxCharsFor<10>() == 40 && uint128::maxCharsFor<16>() == 32);
+
+		char buffer[int128::maxCharsFor<10>()];
+		std::to_chars_result tc = to_chars(buffer, buffer + sizeof(buffer), int128(__int64(-1234567890123LL)));
+		verify ("to_chars decimal", tc.ec == std::errc() && std::string(buffer, tc.ptr) == "-1234567890123");
+
+		tc = to_chars(buffer, buffer + sizeof(buffer), int128(-0x12345), 16);
+		verify ("to_chars hex", tc.ec == std::errc() && std::string(buffer, tc.ptr) == "-12345");
+
+		tc = to_chars(buffer, buffer + sizeof(buffer), uint128(0x12345), 16, digits_format::full_width);
+		verify ("to_chars hex full width", tc.ec == std::errc() && std::string(buffer, tc.ptr) == "00000000000000000000000000012345");
+
+		tc = to_chars(buffer, buffer + 3, int128(1234));
+		verify ("to_chars too small", tc.ec == std::errc::value_too_large);
+
+		const char text[] = "-170141183460469231731687303715884105728 ";
+		int128 parsed;
+		std::from_chars_result fc = from_chars(text, text + sizeof(text) - 1, parsed);
+		verify ("from_chars signed min", fc.ec == std::errc() && *fc.ptr == ' ' && parsed == (int128(1) << 127));
+
+		fc = from_chars(text + 1, text + sizeof(text) - 1, parsed);
+		verify ("from_chars out of range", fc.ec == std::errc::result_out_of_range);
+
+		const char hex[] = "DeadBeef0123456789abcdefXYZ";
+		uint128 parsedHex;
+		fc = from_chars(hex, hex + sizeof(hex) - 1, parsedHex, 16);
+		verify ("from_chars hex", fc.ec == std::errc() && *fc.ptr == 'X' && parsedHex == uint128::fromHexString("0xdeadbeef0123456789abcdef"));
+
+		fc = from_chars(hex + 24, hex + sizeof(hex) - 1, parsedHex, 16);
+		verify ("from_chars no digits", fc.ec == std::errc::invalid_argument && fc.ptr == hex + 24);
+
 		d = int128::fromHexString("0x123761262738abcde746f5253764");
 		verify ("fromHexString +ve", d.toHexString() == "0000123761262738abcde746f5253764");
 
@@ -170,6 +279,16 @@ namespace neo
 		uint128 b = -19234;
 		verify ("unsigned abs (-19234)",  neo::abs(b).toUnsignedInt() == -19234);
 
+		// 32 and 64 bit limbs must agree, including the carries between limbs
+		typedef bigint<8, false, mathprim::u32> uint256_32;
+		typedef bigint<8, false, mathprim::u64> uint256_64;
+
+		uint256_32 x = uint256_32::fromHexString("0xffffffff00000001ffffffffffffffff7fffffff80000000ffffffff00000000");
+		uint256_32 y = uint256_32::fromHexString("0x00000001ffffffff0000000000000001800000017fffffff0000000100000000");
+
+		verify ("add: 32 / 64 bit limbs", (x + y) == (x.cast<uint256_64>() + y.cast<uint256_64>()).cast<uint256_32>());
+		verify ("sub: 32 / 64 bit limbs", (x - y) == (x.cast<uint256_64>() - y.cast<uint256_64>()).cast<uint256_32>());
+		verify ("sub: 32 / 64 bit limbs, borrow", (y - x) == (y.cast<uint256_64>() - x.cast<uint256_64>()).cast<uint256_32>());
 	}
 
 	void bigintTest::testShift()
@@ -222,6 +341,17 @@ namespace neo
 
 		verify ("signed (-0x123456 << 77) >> 77", int128::unsignedCompare (e, e_res) == 0);
 
+		int128 g = int128::fromHexString("0x8123456789abcdef0fedcba987654321");
+		int128::shiftLeft (g, 100, g);
+		verify ("shiftLeft 100 in place", g.toHexString() == "76543210000000000000000000000000");
+
+		g = int128::fromHexString("0x8123456789abcdef0fedcba987654321");
+		int128::shiftRightSigned (g, 100, g);
+		verify ("shiftRightSigned 100 in place", g.toHexString() == "fffffffffffffffffffffffff8123456");
+
+		g = int128::fromHexString("0x8123456789abcdef0fedcba987654321");
+		verify ("shift by the full width", (g << 128) == 0 && (g >> 128) == -1 && (g.cast<uint128>() >> 200) == 0);
+
 		int128 f (1);
 
 		f <<= 40;
@@ -232,6 +362,40 @@ namespace neo
 
 	}
 
+	// multiply pseudo random values with operator* and check the result against the basecase kernel
+	template <typename bigint_t>
+	bool mulMatchesBasecase ()
+	{
+		const size_t numwords = bigint_t::size_words;
+
+		bigint_t a;
+		bigint_t b;
+		mathprim::u32 wa[numwords];
+		mathprim::u32 wb[numwords];
+		mathprim::u32 expected[numwords];
+
+		mathprim::u32 seed = 0x12345678;
+		for (size_t n = 0; n < numwords; n++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			wa[n] = seed;
+			seed = seed * 1664525 + 1013904223;
+			wb[n] = seed;
+
+			a.setWord(n, wa[n]);
+			b.setWord(n, wb[n]);
+		}
+
+		kernels::mulLowBasecase(expected, wa, wb, numwords);
+
+		bigint_t res = a * b;
+		for (size_t n = 0; n < numwords; n++)
+			if (res.getWord(n) != expected[n])
+				return false;
+
+		return true;
+	}
+
 	// http://world.std.com/~reinhold/BigNumCalc.html
 
 	void bigintTest::testMul()
@@ -256,12 +420,123 @@ namespace neo
 
 		verify ("32!",  factorial.toHexString() == "0032ad5a155c6748ac18b9a580000000");
 
+		int128 sres;
+		int128::smul(-int128(0x123456789abcdef0UL), 0x937472435af38478UL, sres);
+		verify ("smul: -0x123456789abcdef0UL * 0x937472435af38478UL",  (-sres).toHexString() == "0a7c557e882c9f916f7538c9e94c4080");
+
+		int128::smul(-int128(0x123456789abcdef0UL), -int128(0x937472435af38478UL), sres);
+		verify ("smul: -0x123456789abcdef0UL * -0x937472435af38478UL",  sres.toHexString() == "0a7c557e882c9f916f7538c9e94c4080");
+
+		uint128 wrap = uint128::fromHexString("0xffffffffffffffffffffffffffffffff");
+		verify ("umul: wrapping (2^128 - 1)^2",  (wrap * wrap) == 1);
+
+		verify ("umul: 2048 bit (Karatsuba)", mulMatchesBasecase< bigint<64, false> >());
+		verify ("umul: 8192 bit (Toom-3)",    mulMatchesBasecase< bigint<256, false> >());
+		verify ("smul: 8192 bit (Toom-3)",    mulMatchesBasecase< bigint<256, true> >());
+		verify ("umul: 32768 bit (NTT)",      mulMatchesBasecase< bigint<1024, false> >());
+		verify ("umul: 32 bit limbs",         mulMatchesBasecase< bigint<8, false, mathprim::u32> >());
+		verify ("umul: 64 bit limbs",         mulMatchesBasecase< bigint<8, false, mathprim::u64> >());
+
+#ifdef BIGNUM_X86_KERNELS
+		if (cpu::getFeatures().bmi2 && cpu::getFeatures().adx)
+		{
+			mathprim::u64 xa[6] = { 0xffffffffffffffffULL, 0x8000000000000001ULL, 0x123456789abcdef0ULL, 0xffffffffffffffffULL, 0, 0xfedcba9876543210ULL };
+			mathprim::u64 xb[6] = { 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0x0fedcba987654321ULL, 1, 0xffffffffffffffffULL, 0x8000000000000000ULL };
+			mathprim::u64 portable[6];
+			mathprim::u64 adx[6];
+
+			kernels::mulLowBasecase<mathprim::u64>(portable, xa, xb, 6);
+			kernels::mulLowBasecaseAdx(adx, xa, xb, 6);
+			verify ("umul: mulx / adx kernel", std::equal(adx, adx + 6, portable));
+		}
+#endif
+
+		{
+			// odd sized operands of all ones put the largest coefficients through the CRT
+			const size_t n = 1001;
+			std::vector<mathprim::u32> a(n, 0xffffffff);
+			std::vector<mathprim::u32> b(n);
+			std::vector<mathprim::u32> ntt(2 * n);
+			std::vector<mathprim::u32> toom(2 * n);
+			std::vector<mathprim::u32> scratch(kernels::mulScratchWords(n));
+
+			mathprim::u32 seed = 0x9e3779b9;
+			for (size_t i = 0; i < n; i++)
+			{
+				seed = seed * 1664525 + 1013904223;
+				b[i] = seed;
+			}
+
+			kernels::mulNTT(ntt.data(), a.data(), b.data(), n, scratch.data() + 1);
+			kernels::mulToom3(toom.data(), a.data(), b.data(), n, scratch.data());
+			verify ("mul: NTT matches Toom-3", ntt == toom);
+
+			kernels::mulNTT(ntt.data(), a.data(), a.data(), n, scratch.data() + 1);
+			kernels::mulToom3(toom.data(), a.data(), a.data(), n, scratch.data());
+			verify ("mul: NTT square matches Toom-3", ntt == toom);
+		}
+
+		uint256 small (unsigned __int64(0xffffffffffffffff));
+		verify ("umul: operands under 2^64", (small * small).toHexString() == "00000000000000000000000000000000fffffffffffffffe0000000000000001");
+
+		bigint<64, false> wide = bigint<64, false>(1) << 2000;
+		wide = wide - 12345;
+		verify ("umul: short operand, wide type", wide * 3 == wide + wide + wide && bigint<64, false>(3) * wide == wide + wide + wide);
+
+		uint256 fa = uint256::fromHexString("0xfedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210");
+		uint256 fb = uint256::fromHexString("0x0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");
+		uint256 fc = uint256::fromHexString("0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+		uint256 fused;
+
+		uint256::mulAdd(fa, fb, fc, fused);
+		verify ("mulAdd", fused == fa * fb + fc);
+		uint256::mulSub(fa, fb, fc, fused);
+		verify ("mulSub", fused == fa * fb - fc);
+		fused = fc;
+		uint256::addMul(fa, fb, fused);
+		verify ("addMul", fused == fc + fa * fb);
+
+		uint256 lhs[3] = { fa, fb, fc };
+		uint256 rhs[3] = { fc, fa, fb };
+		uint256::sumOfProducts(lhs, rhs, 3, fused);
+		verify ("sumOfProducts", fused == fa * fc + fb * fa + fc * fb);
+
+		int128 sfused;
+		int128::mulSub(int128(-7), int128(6), int128(-50), sfused);
+		verify ("mulSub: signed", sfused == 8);
+
+		bigint<64, false> wa = fa.cast< bigint<64, false> >() << 1000;
+		bigint<64, false> wfused;
+		bigint<64, false>::mulAdd(wa, wa, wa, wfused);
+		verify ("mulAdd: 2048 bit", wfused == wa * wa + wa);
+
+		int128 alias (0x123456789abcdef0UL);
+		int128::umul(alias, alias, alias);
+		verify ("umul: aliased result",  alias.toHexString() == "014b66dc33f6acdca5e20890f2a52100");
+
+		uint256::wide_t full = uint256::mulFull(fa, fc);
+		verify ("mulFull", full == fa.cast<uint256::wide_t>() * fc.cast<uint256::wide_t>());
+		verify ("mulHigh", uint256::mulHigh(fa, fc) == fa - 1 && uint256::mulLow(fa, fc) == fa * fc);
+		verify ("mulFull: signed", int128::mulFull(int128(-7), int128(6)) == -42 && int128::mulHigh(int128(-7), int128(6)) == -1);
+
+		int128 smin = int128().minValue();
+		verify ("mulFull: signed minimum", int128::mulFull(smin, smin) == int128::wide_t(1) << 254);
+
+		uint256 product;
+		verify ("umulOverflow", uint256::umulOverflow(fa, fc, product) && product == fa * fc);
+		verify ("umulOverflow: none", !uint256::umulOverflow(fb, uint256(15), product) && product == fb * 15);
+		verify ("umulOverflow: boundary", !uint256::umulOverflow(uint256(1) << 128, (uint256(1) << 128) - 1, product) && uint256::umulOverflow(uint256(1) << 128, uint256(1) << 128, product));
 	}
 
 	void bigintTest::testDiv()
 	{
 		TRACE_FUNCTION();
 
+		uint256 quotient, remainder;
+		uint256::udiv(uint256(unsigned __int64(0xfedcba9876543210)), uint256(unsigned __int64(0x123456789)), quotient, remainder);
+		verify ("udiv: operands under 2^64", quotient == 0xe0000000 && remainder == 0x96543210);
+		verify ("toDecString: under 2^64", uint256(unsigned __int64(0xffffffffffffffff)).toDecString() == "18446744073709551615");
+
 		if (true)
 		{
 			int128 result (0x123456789abcdef0UL);
@@ -316,9 +591,279 @@ namespace neo
 			verify ("divide by zero exception", divExcept);
 
 		}
+
+		if (true)
+		{
+			uint256 a = uint256::fromHexString("0x123456789abcdef0123456789abcdef0");
+			uint256 square = a * a;
+
+			verify ("uint256: a*a / a", (square / a) == a);
+			verify ("uint256: (a*a + 5) % a", ((square + 5) % a) == 5);
+			verify ("uint256: (a*a + a - 1) / a", ((square + a - 1) / a) == a);
+
+			uint256 allOnes = uint256::fromHexString("0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+			uint256 divisor = uint256::fromHexString("0x100000000000000000000000000000001");
+			verify ("uint256: (2^256 - 1) / (2^128 + 1)", (allOnes / divisor).toHexString() == "00000000000000000000000000000000ffffffffffffffffffffffffffffffff");
+			verify ("uint256: (2^256 - 1) % (2^128 + 1)", (allOnes % divisor) == 0);
+
+			uint256 quotient;
+			uint256::divexact(square, a, quotient);
+			verify ("uint256: divexact a*a / a", quotient == a);
+
+			uint256::divexact(square << 40, a << 7, quotient);
+			verify ("uint256: divexact (a*a << 40) / (a << 7)", quotient == (a << 33));
+
+			int256 sa = int256::fromHexString("-0x123456789abcdef0123456789abcdef0");
+			int256 sq;
+			int256::divexact(sa * sa * 3, sa, sq);
+			verify ("int256: divexact 3*a*a / -a", sq == sa * 3);
+
+			verify ("isDivisibleBy: a*a by a",       square.isDivisibleBy(a));
+			verify ("isDivisibleBy: a*a + 1 by a",   !(square + 1).isDivisibleBy(a));
+			verify ("isDivisibleBy: 1000 by 8",      uint256(1000).isDivisibleBy(8));
+			verify ("isDivisibleBy: 1000 by 16",     !uint256(1000).isDivisibleBy(16));
+			verify ("isDivisibleBy: -1000 by 125",   int256(-1000).isDivisibleBy(125));
+			verify ("isDivisibleBy: 1000 by -3",     !int256(1000).isDivisibleBy(-3));
+			verify ("isDivisibleBy: 0 by a",         uint256(0).isDivisibleBy(a));
+		}
+
+		if (true)
+		{
+			uint256 value = uint256::fromDecString("115792089237316195423570985008687907853269984665640564039457584007913129639935");
+
+			uint256::divider byPrime (uint256::fromDecString("340282366920938463463374607431768211297"));
+			verify ("divider: multi word div", byPrime.div(value).toDecString() == "340282366920938463463374607431768211615");
+			verify ("divider: multi word mod", byPrime.mod(value).toDecString() == "25280");
+
+			uint256::divider by7 (7);
+			uint256 quotient;
+			uint256 modulo;
+			by7.divmod(value, quotient, modulo);
+			verify ("divider: single word divmod", quotient == value / 7 && modulo == value % 7);
+
+			int256::divider byMinus1000 (-1000);
+			verify ("divider: signed div", byMinus1000.div(int256(123456)) == -123);
+			verify ("divider: signed mod", byMinus1000.mod(int256(-123456)) == 456);
+
+			bigint<64, false> wideValue = (bigint<64, false>(value.cast< bigint<64, false> >()) << 1700) + 12345;
+			bigint<64, false> wideDivisor = (bigint<64, false>(1) << 1100) - 3;
+			bigint<64, false>::divider byWide (wideDivisor);
+			verify ("divider: wide", byWide.div(wideValue) == wideValue / wideDivisor && byWide.mod(wideValue) == wideValue % wideDivisor);
+
+			mathprim::u32 rem = uint256::divc<10>::divmod(value, quotient);
+			verify ("divc<10>: div", quotient.toDecString() == "11579208923731619542357098500868790785326998466564056403945758400791312963993");
+			verify ("divc<10>: mod", rem == 5);
+			verify ("divc<1000000000>: mod", int256::divc<1000000000>::mod(int256(__int64(-1234567890123LL))) == 567890123);
+		}
 	}
 
+	void bigintTest::testModular()
+	{
+		TRACE_FUNCTION();
 
+		typedef bigint<16, false> uint512;
 
-}
+		// 2^255 - 19
+		uint256 p = uint256::fromHexString("0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+		uint256 a = uint256::fromHexString("0x5a4f2b8c9d7e6f10293847566574839201abcdef0123456789abcdef01234567");
+		uint256 b = uint256::fromHexString("0x1122334455667788990011223344556677889900aabbccddeeff001122334455");
+
+		montgomery_context<uint256> ctx (p);
+
+		uint256 expected = ((a.cast<uint512>() * b.cast<uint512>()) % p.cast<uint512>()).cast<uint256>();
+
+		uint256 am = ctx.toMontgomery(a);
+		uint256 bm = ctx.toMontgomery(b);
+
+		verify ("montgomery: round trip", ctx.fromMontgomery(am) == a);
+		verify ("montgomery: R^2 mod p", ctx.rSquared() == 1444);
+		verify ("montgomery: -p^-1 mod 2^32", ctx.minv() * p.getWord(0) == 0xffffffff);
+		verify ("montgomery: mulmod", ctx.fromMontgomery(ctx.mulmod(am, bm)) == expected);
+		verify ("montgomery: sqrmod", ctx.sqrmod(am) == ctx.mulmod(am, am));
+		verify ("montgomery: addmod", ctx.fromMontgomery(ctx.addmod(am, bm)) == (a + b) % p);
+		verify ("montgomery: submod", ctx.fromMontgomery(ctx.submod(bm, am)) == p - a + b);
+		verify ("montgomery: one", ctx.mulmod(ctx.one(), am) == am);
+
+		constexpr montgomery_context<uint256> constCtx ((uint256(1) << 255) - 19);
+		constexpr uint256 constR2 = constCtx.rSquared();
+		verify ("montgomery: constexpr context", constCtx.modulus() == p && constR2 == 1444);
+
+		bool evenExcept = false;
+		try
+		{
+			montgomery_context<uint256> even (uint256(1000));
+		}
+		catch (std::invalid_argument&)
+		{
+			evenExcept = true;
+		}
+		verify ("montgomery: even modulus exception", evenExcept);
+
+		verify ("powmod: fermat", powmod(a, p - 1, p) == 1);
+		verify ("powmod: odd modulus", powmod(a, b, p) == ctx.fromMontgomery(ctx.mulmod(ctx.toMontgomery(powmod(a, b - 1, p)), am)));
+		verify ("powmod: even modulus", powmod(a, b, uint256::fromDecString("10000000000000000000000000000000000000000")) == uint256::fromDecString("8721245216275037646588968614906888142599"));
+		verify ("powmod: small", powmod(uint256(12345), uint256(67), uint256(1000000)) == 515625);
+		verify ("powmod: zero exponent", powmod(a, uint256(0), p) == 1);
+		verify ("powmod: modulus one", powmod(a, b, uint256(1)) == 0);
+
+		verify ("pow: wrapping", pow(uint256(3), 200) == uint256::fromHexString("0xc21a937a76f3432ffd73d97e447606b683ecf6f6e4a7ae225bfaff1eaaf8b0a1"));
+		verify ("pow: signed", pow(int256(-7), 5) == -16807);
+		verify ("pow: zero exponent", pow(int256(-7), 0) == 1);
+	}
+
+	void bigintTest::testRoots()
+	{
+		TRACE_FUNCTION();
+
+		typedef bigint<16, false> uint512;
+
+		uint256 a = uint256::fromHexString("0x5a4f2b8c9d7e6f10293847566574839201abcdef0123456789abcdef01234567");
+		uint256 root = isqrt(a);
+
+		verify ("isqrt: 256 bit", root == uint256::fromDecString("202108975200714315947049836745743797790"));
+		verify ("isqrt: floor", root * root <= a && (root + 1) * (root + 1) > a);
+		verify ("isqrt: small", isqrt(uint256(0)) == 0 && isqrt(uint256(1)) == 1 && isqrt(uint256(99)) == 9 && isqrt(uint256(100)) == 10);
+		verify ("isqrt: max", isqrt(uint256(0) - 1) == (uint256(1) << 128) - 1);
+		verify ("isqrt: 512 bit square", isqrt(a.cast<uint512>() * a.cast<uint512>()) == a.cast<uint512>());
+
+		verify ("iroot: cube", iroot<3>(a) == uint256::fromDecString("34439518159894991939288977"));
+		verify ("iroot: cube below", iroot<3>(uint256(1000000) * 1000000 * 1000000 - 1) == 999999);
+		verify ("iroot: 1", iroot<1>(a) == a);
+
+		verify ("isPerfectSquare: square", isPerfectSquare(root * root));
+		verify ("isPerfectSquare: square + 1", !isPerfectSquare(root * root + 1));
+		verify ("isPerfectSquare: square - 1", !isPerfectSquare(root * root - 1));
+		verify ("isPerfectSquare: 0, 1", isPerfectSquare(uint256(0)) && isPerfectSquare(uint256(1)));
+		verify ("isPerfectSquare: negative", !isPerfectSquare(int256(-4)));
+
+		bool negative = false;
+		try
+		{
+			isqrt(int256(-4));
+		}
+		catch (std::out_of_range&)
+		{
+			negative = true;
+		}
+		verify ("isqrt: negative exception", negative);
+	}
+
+	void bigintTest::testGcd()
+	{
+		TRACE_FUNCTION();
+
+		typedef bigint<2, false> uint64;
+
+		// 2^64 3^60 and 2^20 3^90 7
+		uint256 a = uint256::fromDecString("781978847691028119829164036380393661850573602816");
+		uint256 b = uint256::fromDecString("64063531884597988012840486024078521931179116986368");
+		uint256 g = uint256::fromDecString("44450351179593105816204799588171776");
+
+		verify ("gcd: 256 bit", gcd(a, b) == g && gcd(b, a) == g);
+		verify ("gcd: zero", gcd(a, uint256(0)) == a && gcd(uint256(0), b) == b);
+		verify ("gcd: binary", gcd(uint64(48), uint64(180)) == 12 && gcd(uint64(0) - 1, uint64(0) - 3) == 1);
+		verify ("gcd: signed", gcd(int256(-48), int256(180)) == 12);
+		verify ("lcm: 256 bit", lcm(a, b) == uint256::fromDecString("1127017571576224172533964454044312863663853855435196980514521088"));
+		verify ("lcm: zero", lcm(a, uint256(0)) == 0);
+
+		int256 x, y;
+		int256 sa = -a.cast<int256>();
+		int256 sb = b.cast<int256>();
+		verify ("xgcd: bezout", xgcd(sa, sb, x, y) == g.cast<int256>() && sa * x + sb * y == g.cast<int256>());
+		verify ("xgcd: minimal", x * 2 * g.cast<int256>() <= sb && -x * 2 * g.cast<int256>() <= sb);
+
+		uint256 p = uint256::fromHexString("0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+		verify ("modInverse: 2^255 - 19", modInverse(a % p, p) == uint256::fromDecString("37160097652942269805903893587974959827868734438746695550699972257031584063136"));
+		verify ("modInverse: negative", modInverse(int256(-3), int256(7)) == 2);
+
+		bool notInvertible = false;
+		try
+		{
+			modInverse(uint256(6), uint256(9));
+		}
+		catch (std::invalid_argument&)
+		{
+			notInvertible = true;
+		}
+		verify ("modInverse: not invertible exception", notInvertible);
+	}
+
+	void bigintTest::testBatch()
+	{
+		TRACE_FUNCTION();
+
+		// 11 elements: two vector groups and a scalar tail
+		const size_t count = 11;
+		typedef bigint_batch<count, 8> batch_t;
+
+		uint256 p = uint256::fromHexString("0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed");
+		montgomery_context<uint256> ctx (p);
 
+		uint256 a[count];
+		uint256 b[count];
+
+		mathprim::u32 seed = 0x2468ace0;
+		for (size_t i = 0; i < count; i++)
+		{
+			for (size_t w = 0; w < 8; w++)
+			{
+				seed = seed * 1664525 + 1013904223;
+				a[i].setWord(w, seed);
+				seed = seed * 1664525 + 1013904223;
+				b[i].setWord(w, i % 3 ? seed : ~a[i].getWord(w));
+			}
+			a[i] = a[i] % p;
+		}
+		b[4] = a[4];
+		b[9] = 0;
+
+		batch_t ba;
+		batch_t bb;
+		batch_t br;
+		uint256 r[count];
+		int cmp[count];
+
+		ba.load(a);
+		bb.load(b);
+
+		batch_t::add(ba, bb, br);
+		br.store(r);
+		bool addOk = true;
+		for (size_t i = 0; i < count; i++)
+			addOk = addOk && r[i] == a[i] + b[i];
+		verify ("batch: add", addOk);
+
+		batch_t::sub(ba, bb, br);
+		br.store(r);
+		bool subOk = true;
+		for (size_t i = 0; i < count; i++)
+			subOk = subOk && r[i] == a[i] - b[i];
+		verify ("batch: sub", subOk);
+
+		batch_t::compare(ba, bb, cmp);
+		bool cmpOk = true;
+		for (size_t i = 0; i < count; i++)
+			cmpOk = cmpOk && cmp[i] == uint256::unsignedCompare(a[i], b[i]);
+		verify ("batch: compare", cmpOk && cmp[4] == 0);
+
+		batch_t::mul(ba, bb, br);
+		br.store(r);
+		bool mulOk = true;
+		for (size_t i = 0; i < count; i++)
+			mulOk = mulOk && r[i] == a[i] * b[i];
+		verify ("batch: mul", mulOk);
+
+		for (size_t i = 0; i < count; i++)
+			b[i] = b[i] % p;
+		bb.load(b);
+
+		batch_t::montgomeryMul(ba, bb, ctx, br);
+		bool montOk = true;
+		for (size_t i = 0; i < count; i++)
+			montOk = montOk && br.get(i) == ctx.mulmod(a[i], b[i]);
+		verify ("batch: montgomeryMul", montOk);
+
+		batch_t::add(ba, ba, ba);
+		verify ("batch: aliased add", ba.get(7) == a[7] + a[7]);
+	}
+}
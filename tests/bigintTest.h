@@ -22,6 +22,10 @@ namespace neo
 			void testShift ();
 			void testMul ();
 			void testDiv ();
+			void testModular ();
+			void testRoots ();
+			void testGcd ();
+			void testBatch ();
 
 		public:
 			bigintTest ();
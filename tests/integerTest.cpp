@@ -0,0 +1,225 @@
+
+#include "neo/Logging.h"
+
+#include "integerTest.h"
+
+
+USE_LOGGING_CATEGORY (test);
+
+namespace neo
+{
+
+	integerTest::integerTest() : m_passed (true), m_numPassed(0), m_numFailed(0)
+	{
+	    
+	}
+
+	bool integerTest::doTests()
+	{
+		TRACE_FUNCTION();
+	 
+		testInitialise();
+		testCompare();
+		testAddSub ();
+		testShift ();
+		testMul ();
+		testDiv ();
+		testAllocator ();
+
+		LOGMSG (INFO, "");
+		LOGMSG (INFO, neo::makeString("************************************************************"));
+		LOGMSG (INFO, neo::makeString("**  Tests complete: ", m_passed?" [PASSED] ":" [FAILED] "));
+		LOGMSG (INFO, neo::makeString("**    Tests Passed: ", m_numPassed));
+		LOGMSG (INFO, neo::makeString("**    Tests Failed: ", m_numFailed));
+		LOGMSG (INFO, neo::makeString("************************************************************"));
+		LOGMSG (INFO, "");
+
+		return m_passed;
+	}
+
+	void integerTest::verify (const std::string& testname, bool outcome)
+	{   
+		if (!outcome) 
+		{
+			m_passed = false;
+			m_numFailed++;
+		}
+		else
+		{
+			m_numPassed++;
+		}
+
+		LOGMSG (INFO, neo::makeString(outcome?"[PASSED] ":"[FAILED] ", testname));
+	}
+
+	static integer power (int base, int exponent)
+	{
+		integer result (1);
+		while (exponent--)
+			result *= integer(base);
+		return result;
+	}
+
+	void integerTest::testInitialise()
+	{
+		TRACE_FUNCTION();
+
+		verify ("init default", integer().toDecString() == "0" && integer().isZero() && !integer().isNegative());
+		verify ("init -100", integer(-100).toDecString() == "-100");
+		verify ("init int64 min", integer(__int64(0x8000000000000000LL)).toDecString() == "-9223372036854775808");
+		verify ("init uint64 max", integer(unsigned __int64(0xffffffffffffffffULL)).toHexString() == "ffffffffffffffff");
+
+		std::string digits = "-1234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890";
+		verify ("fromDecString: 100 digits", integer::fromDecString(digits).toDecString() == digits);
+		verify ("fromDecString: -0", !integer::fromDecString("-0").isNegative());
+		verify ("fromHexString", integer::fromHexString("-0x000123456789abcdef0123456789").toHexString() == "-123456789abcdef0123456789");
+
+		uint256 max = uint256(0) - 1;
+		verify ("init uint256 max", integer(max).toDecString() == "115792089237316195423570985008687907853269984665640564039457584007913129639935");
+		verify ("cast int256", integer(int256(-12345)).cast<int256>() == int256(-12345) && integer(max).cast<uint256>() == max);
+		verify ("cast wraps", (integer(max) + integer(2)).cast<uint256>() == 1);
+
+		integer big = power(3, 200);
+		integer moved = std::move(big);
+		verify ("move", moved == power(3, 200) && big.isZero());
+
+		bool invalid = false;
+		try
+		{
+			integer::fromDecString("12a4");
+		}
+		catch (std::invalid_argument&)
+		{
+			invalid = true;
+		}
+		verify ("fromDecString: invalid digit", invalid);
+	}
+
+	void integerTest::testCompare()
+	{
+		TRACE_FUNCTION();
+
+		verify ("compare: <  sign", integer(-1000) < integer(1));
+		verify ("compare: <  negative", integer(-1000) < integer(-999));
+		verify ("compare: >  size", power(2, 100) > power(2, 99) && -power(2, 100) < -power(2, 99));
+		verify ("compare: == ", power(7, 50) == power(7, 50) && power(7, 50) != power(7, 50) + integer(1));
+		verify ("compare: <= >=", integer(5) <= integer(5) && integer(5) >= integer(5));
+	}
+
+	void integerTest::testAddSub()
+	{
+		TRACE_FUNCTION();
+
+		integer one (1);
+		integer x = power(2, 1000);
+
+		verify ("add: carry out of every word", (x - one) + one == x);
+		verify ("sub: borrow through every word", (x - one).toHexString() == std::string(250, 'f'));
+		verify ("add: mixed signs", (integer(-5) + integer(3)).toDecString() == "-2" && (integer(5) + integer(-3)).toDecString() == "2");
+		verify ("sub: to zero", (x - x).isZero() && !(x - x).isNegative());
+		verify ("sub: negative result", integer(3) - integer(5) == integer(-2));
+
+		integer y = x;
+		y += y;
+		y -= x;
+		verify ("add/sub: in place", y == x);
+		verify ("add: temporaries", power(3, 100) + power(3, 100) + power(3, 100) == power(3, 101));
+		verify ("negate", -(-x) == x && (-integer()).toDecString() == "0");
+	}
+
+	void integerTest::testShift()
+	{
+		TRACE_FUNCTION();
+
+		verify ("shift: << >>", (integer(1) << 1000) >> 1000 == integer(1) && (integer(1) << 1000) == power(2, 1000));
+		verify ("shift: >> past the top", (power(2, 100) >> 200).isZero() && (-power(2, 100) >> 200) == integer(-1));
+		verify ("shift: >> negative rounds down", (integer(-5) >> 1) == integer(-3) && (integer(-4) >> 1) == integer(-2));
+		verify ("shift: << 33", (integer(-3) << 33).toDecString() == "-25769803776");
+	}
+
+	void integerTest::testMul()
+	{
+		TRACE_FUNCTION();
+
+		verify ("mul: signs", integer(-6) * integer(7) == integer(-42) && integer(-6) * integer(-7) == integer(42));
+		verify ("mul: zero", (power(3, 100) * integer()).isZero() && !(integer(-1) * integer()).isNegative());
+		verify ("mul: 3^200 7^150", (power(3, 200) * power(7, 150)).toDecString() == "1545101257814748811286727736572536270706483327297185697793885263277354859652706304126519484226947610814588288262599563584162768191197920185985531058108279032100758920551854034740250965614345760459124467215428114258962147249");
+
+		// 94 by 47 words, cut into two Karatsuba pieces
+		integer x = power(2, 3000) + integer(12345);
+		integer y = power(2, 1500) - integer(1);
+		verify ("mul: unbalanced", (x * y) % power(10, 30) == integer::fromDecString("792505498533927150538163474375") && (x * y) / y == x);
+		verify ("mul: square", x * x == power(2, 6000) + power(2, 3001) * integer(12345) + integer(12345) * integer(12345));
+
+		// over BIGNUM_NTT_THRESHOLD words
+		integer big = power(2, 40000) - integer(1);
+		integer odd = power(3, 20000) + integer(1);
+		verify ("mul: NTT", (big * odd) / odd == big && (big * odd) % power(2, 40000) == power(2, 40000) - odd);
+		verify ("mul: NTT square", big * big == power(2, 80000) - power(2, 40001) + integer(1));
+	}
+
+	void integerTest::testDiv()
+	{
+		TRACE_FUNCTION();
+
+		verify ("div: truncates", integer(-7) / integer(2) == integer(-3) && integer(7) / integer(-2) == integer(-3));
+		verify ("mod: sign of dividend", integer(-7) % integer(2) == integer(-1) && integer(7) % integer(-2) == integer(1));
+
+		integer a = power(3, 200) * power(7, 150);
+		integer d = power(7, 150) + integer(12345);
+		verify ("div: 3^200 7^150 / (7^150 + 12345)", (a / d).toDecString() == "265613988875874769338781322035779626829233452653394495974574961739092490901302182994384699044000");
+		verify ("mod: 3^200 7^150 % (7^150 + 12345)", (a % d).toDecString() == "5817092933824343165432524000112686472247185622232085112095867714400769886028201942760461805225113957690252164556042017798011249");
+		verify ("div: smaller dividend", (d / a).isZero() && d % a == d);
+
+		integer q = a;
+		q /= integer(1000000007);
+		verify ("div: single word", q * integer(1000000007) + a % integer(1000000007) == a);
+
+		bool divideByZero = false;
+		try
+		{
+			a / integer();
+		}
+		catch (std::invalid_argument&)
+		{
+			divideByZero = true;
+		}
+		verify ("div: divide by zero", divideByZero);
+	}
+
+	void integerTest::testAllocator()
+	{
+		TRACE_FUNCTION();
+
+		typedef basic_integer<heap_allocator> heap_integer;
+		heap_integer h (1);
+		for (int i = 0; i < 200; i++)
+			h *= heap_integer(3);
+		verify ("heap_allocator", h.toDecString() == power(3, 200).toDecString() && h / heap_integer(3) * heap_integer(3) == h);
+
+		{
+			scratch_scope outer;
+			mathprim::u32* first = outer.allocate(100);
+			{
+				scratch_scope inner;
+				inner.allocate(50000);
+			}
+			scratch_scope next;
+			verify ("scratch_scope: rewinds", next.allocate(4) == first + 100);
+		}
+
+		// warm the pools, then the same work again allocates nothing
+		integer a = power(3, 2000);
+		integer b = power(7, 300);
+		auto work = [&] { return (a * b / (b + integer(1)) % b).isZero(); };
+		work ();
+
+		allocation_counters before = allocationCounters();
+		work ();
+		allocation_counters after = allocationCounters();
+
+		verify ("pooled_allocator: no allocations", after.allocations == before.allocations);
+		verify ("pooled_allocator: avoided", after.allocationsAvoided > before.allocationsAvoided && after.bytesAvoided > before.bytesAvoided);
+	}
+
+}
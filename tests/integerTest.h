@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "integer.h"
+
+namespace neo
+{
+	class integerTest
+	{
+		private:
+			bool m_passed;
+			int m_numPassed;
+			int m_numFailed;
+
+			void verify (const std::string& testname, bool outcome); 
+
+			void testInitialise ();
+			void testCompare ();
+			void testAddSub ();
+			void testShift ();
+			void testMul ();
+			void testDiv ();
+			void testAllocator ();
+
+		public:
+			integerTest ();
+
+			bool doTests();
+	};
+}